@@ -0,0 +1,240 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+#include "common.h"
+#include "aabb.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AABB_X86 1
+#include <immintrin.h>
+#endif
+
+// GCC and Clang only emit AVX2 inside functions marked for it; MSVC takes the intrinsics as they are.
+#if defined(__GNUC__)
+#define AABB_AVX2 __attribute__((target("avx2")))
+#else
+#define AABB_AVX2
+#endif
+
+// Batch narrowphase: one query box against a run of candidate boxes, writing the indices of
+// the boxes it overlaps. Boxes are [min, max) on both axes and an empty box overlaps nothing,
+// which is what the old integer collision() computed. Every kernel uses ordered less-than, so
+// all of them agree exactly, NaNs included. The widest kernel the CPU runs is picked at start.
+
+typedef int (*AabbKernel)(const AabbBatch *batch, int from, const float *query, int *hits);
+
+typedef struct
+{
+	const char *name;
+	AabbKernel kernel;
+	SDL_bool (*supported)(void);
+} AabbKernelInfo;
+
+static int sweepAxis(float min, float max, float d, float targetMin, float targetMax, float *enter, float *leave);
+static int overlapScalar(const AabbBatch *batch, int from, const float *query, int *hits);
+static SDL_bool alwaysSupported(void);
+#ifdef AABB_X86
+static int overlapSSE2(const AabbBatch *batch, int from, const float *query, int *hits);
+static int overlapAVX2(const AabbBatch *batch, int from, const float *query, int *hits);
+#endif
+
+// Fastest last; selectAabbKernel(NULL) takes the last one supported.
+static const AabbKernelInfo kernels[] = {
+	{"scalar", overlapScalar, alwaysSupported},
+#ifdef AABB_X86
+	{"sse2", overlapSSE2, SDL_HasSSE2},
+	{"avx2", overlapAVX2, SDL_HasAVX2},
+#endif
+};
+
+#define NUM_KERNELS ((int)(sizeof(kernels) / sizeof(kernels[0])))
+
+static const AabbKernelInfo *current = &kernels[0];
+
+const char *selectAabbKernel(const char *name)
+{
+	int i;
+
+	for (i = NUM_KERNELS - 1; i >= 0; i--)
+	{
+		if ((name == NULL || strcmp(name, kernels[i].name) == 0) && kernels[i].supported())
+		{
+			current = &kernels[i];
+			return current->name;
+		}
+	}
+
+	return NULL;
+}
+
+const char *getAabbKernel(void)
+{
+	return current->name;
+}
+
+const char *aabbKernelName(int index)
+{
+	return (index >= 0 && index < NUM_KERNELS) ? kernels[index].name : NULL;
+}
+
+int overlapAabbs(const AabbBatch *batch, const float *query, int *hits)
+{
+	if (!(query[0] < query[2] && query[1] < query[3]))
+	{
+		return 0;
+	}
+
+	return current->kernel(batch, 0, query, hits);
+}
+
+// Moves box by (dx, dy) over one tick against a target that stays put; both are minX, minY,
+// maxX, maxY like a query. If they overlap at any point of the tick, returns 1 and the part
+// of the tick they overlap for, as fractions from 0 (box where it started) to 1 (box + d).
+// At 0 movement this is the static overlap test, so a box that ends inside is still a hit.
+int sweepAabb(const float *box, float dx, float dy, const float *target, float *enter, float *leave)
+{
+	*enter = 0;
+	*leave = 1;
+
+	if (!(box[0] < box[2] && box[1] < box[3] && target[0] < target[2] && target[1] < target[3]))
+	{
+		return 0;
+	}
+
+	return sweepAxis(box[0], box[2], dx, target[0], target[2], enter, leave)
+		&& sweepAxis(box[1], box[3], dy, target[1], target[3], enter, leave);
+}
+
+// Narrows [enter, leave] to the part of the tick the boxes overlap on one axis.
+static int sweepAxis(float min, float max, float d, float targetMin, float targetMax, float *enter, float *leave)
+{
+	float t0, t1;
+
+	if (d == 0)
+	{
+		return min < targetMax && targetMin < max;
+	}
+
+	// Overlap is strict, so the boxes overlap strictly between touching at t0 and parting at t1.
+	t0 = (targetMin - max) / d;
+	t1 = (targetMax - min) / d;
+
+	if (d < 0)
+	{
+		*enter = MAX(*enter, t1);
+		*leave = MIN(*leave, t0);
+	}
+	else
+	{
+		*enter = MAX(*enter, t0);
+		*leave = MIN(*leave, t1);
+	}
+
+	return *enter < *leave;
+}
+
+static int overlapScalar(const AabbBatch *batch, int from, const float *query, int *hits)
+{
+	int i, n;
+
+	n = 0;
+
+	for (i = from; i < batch->count; i++)
+	{
+		if (query[0] < batch->maxX[i] && batch->minX[i] < query[2] && query[1] < batch->maxY[i] && batch->minY[i] < query[3]
+			&& batch->minX[i] < batch->maxX[i] && batch->minY[i] < batch->maxY[i])
+		{
+			hits[n++] = i;
+		}
+	}
+
+	return n;
+}
+
+static SDL_bool alwaysSupported(void)
+{
+	return SDL_TRUE;
+}
+
+#ifdef AABB_X86
+static int overlapSSE2(const AabbBatch *batch, int from, const float *query, int *hits)
+{
+	__m128 qx0, qy0, qx1, qy1, x0, y0, x1, y1, m;
+	int i, j, n, bits;
+
+	qx0 = _mm_set1_ps(query[0]);
+	qy0 = _mm_set1_ps(query[1]);
+	qx1 = _mm_set1_ps(query[2]);
+	qy1 = _mm_set1_ps(query[3]);
+
+	n = 0;
+
+	for (i = from; i + 4 <= batch->count; i += 4)
+	{
+		x0 = _mm_loadu_ps(batch->minX + i);
+		y0 = _mm_loadu_ps(batch->minY + i);
+		x1 = _mm_loadu_ps(batch->maxX + i);
+		y1 = _mm_loadu_ps(batch->maxY + i);
+
+		m = _mm_and_ps(_mm_cmplt_ps(qx0, x1), _mm_cmplt_ps(x0, qx1));
+		m = _mm_and_ps(m, _mm_and_ps(_mm_cmplt_ps(qy0, y1), _mm_cmplt_ps(y0, qy1)));
+		m = _mm_and_ps(m, _mm_and_ps(_mm_cmplt_ps(x0, x1), _mm_cmplt_ps(y0, y1)));
+
+		for (bits = _mm_movemask_ps(m), j = 0; bits != 0; bits >>= 1, j++)
+		{
+			if (bits & 1)
+			{
+				hits[n++] = i + j;
+			}
+		}
+	}
+
+	return n + overlapScalar(batch, i, query, hits + n);
+}
+
+AABB_AVX2 static int overlapAVX2(const AabbBatch *batch, int from, const float *query, int *hits)
+{
+	__m256 qx0, qy0, qx1, qy1, x0, y0, x1, y1, m;
+	int i, j, n, bits;
+
+	qx0 = _mm256_set1_ps(query[0]);
+	qy0 = _mm256_set1_ps(query[1]);
+	qx1 = _mm256_set1_ps(query[2]);
+	qy1 = _mm256_set1_ps(query[3]);
+
+	n = 0;
+
+	for (i = from; i + 8 <= batch->count; i += 8)
+	{
+		x0 = _mm256_loadu_ps(batch->minX + i);
+		y0 = _mm256_loadu_ps(batch->minY + i);
+		x1 = _mm256_loadu_ps(batch->maxX + i);
+		y1 = _mm256_loadu_ps(batch->maxY + i);
+
+		m = _mm256_and_ps(_mm256_cmp_ps(qx0, x1, _CMP_LT_OQ), _mm256_cmp_ps(x0, qx1, _CMP_LT_OQ));
+		m = _mm256_and_ps(m, _mm256_and_ps(_mm256_cmp_ps(qy0, y1, _CMP_LT_OQ), _mm256_cmp_ps(y0, qy1, _CMP_LT_OQ)));
+		m = _mm256_and_ps(m, _mm256_and_ps(_mm256_cmp_ps(x0, x1, _CMP_LT_OQ), _mm256_cmp_ps(y0, y1, _CMP_LT_OQ)));
+
+		for (bits = _mm256_movemask_ps(m), j = 0; bits != 0; bits >>= 1, j++)
+		{
+			if (bits & 1)
+			{
+				hits[n++] = i + j;
+			}
+		}
+	}
+
+	// The tail stays in this function: leaving AVX code for SSE code mid-batch costs more than it saves.
+	for (; i < batch->count; i++)
+	{
+		if (query[0] < batch->maxX[i] && batch->minX[i] < query[2] && query[1] < batch->maxY[i] && batch->minY[i] < query[3]
+			&& batch->minX[i] < batch->maxX[i] && batch->minY[i] < batch->maxY[i])
+		{
+			hits[n++] = i;
+		}
+	}
+
+	return n;
+}
+#endif
@@ -0,0 +1,9 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+const char *selectAabbKernel(const char *name);
+const char *getAabbKernel(void);
+const char *aabbKernelName(int index);
+int overlapAabbs(const AabbBatch *batch, const float *query, int *hits);
+int sweepAabb(const float *box, float dx, float dy, const float *target, float *enter, float *leave);
@@ -0,0 +1,155 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+#include "common.h"
+#include "arena.h"
+#include "memtrack.h"
+#include "metrics.h"
+#include "util.h"
+
+extern App app;
+
+// Main thread only. The frame arena is wiped at the top of every doFrame(); the two keep
+// arenas alternate, so anything from frameAllocKeep() is still valid during the next frame.
+static Arena frameArena;
+static Arena keepArenas[2];
+static Arena *keepArena;
+
+void initArena(Arena *arena, const char *name, size_t size)
+{
+	memset(arena, 0, sizeof(Arena));
+
+	arena->name = name;
+	arena->size = size;
+	arena->base = memAlloc(size, MEM_TAG_POOLS);
+
+	if (arena->base == NULL)
+	{
+		LOG_ERROR(LOG_CAT_APP, "Couldn't allocate %s arena (%d bytes).", name, (int)size);
+		exit(1);
+	}
+}
+
+void destroyArena(Arena *arena)
+{
+	if (arena->base != NULL)
+	{
+		LOG_INFO(LOG_CAT_APP, "Arena '%s': peak %d of %d bytes, %ld overflows.", arena->name, (int)arena->peak, (int)arena->size, arena->overflows);
+	}
+
+	memFree(arena->base);
+	memset(arena, 0, sizeof(Arena));
+}
+
+void *arenaAlloc(Arena *arena, size_t size)
+{
+	size_t offset;
+
+	offset = (arena->used + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+
+	if (offset + size > arena->size)
+	{
+		// Never fall back to the heap: count it and let the caller skip the work.
+		arena->overflows++;
+
+		if (shouldWarn(arena->overflows))
+		{
+			LOG_WARN(LOG_CAT_APP, "Arena '%s' overflow: %d bytes requested with %d of %d used (%ld overflows).",
+				arena->name, (int)size, (int)arena->used, (int)arena->size, arena->overflows);
+		}
+
+		return NULL;
+	}
+
+	arena->used = offset + size;
+	arena->peak = MAX(arena->peak, arena->used);
+
+	return arena->base + offset;
+}
+
+char *arenaFormat(Arena *arena, const char *format, va_list args)
+{
+	va_list measure;
+	char *text;
+	int len;
+
+	va_copy(measure, args);
+	len = vsnprintf(NULL, 0, format, measure);
+	va_end(measure);
+
+	if (len < 0)
+	{
+		return NULL;
+	}
+
+	text = arenaAlloc(arena, len + 1);
+	if (text != NULL)
+	{
+		vsnprintf(text, len + 1, format, args);
+	}
+
+	return text;
+}
+
+void arenaReset(Arena *arena)
+{
+	arena->used = 0;
+}
+
+void initFrameArenas(void)
+{
+	initArena(&frameArena, "frame", FRAME_ARENA_SIZE);
+	initArena(&keepArenas[0], "keep0", KEEP_ARENA_SIZE);
+	initArena(&keepArenas[1], "keep1", KEEP_ARENA_SIZE);
+
+	keepArena = &keepArenas[0];
+}
+
+void shutdownFrameArenas(void)
+{
+	destroyArena(&frameArena);
+	destroyArena(&keepArenas[0]);
+	destroyArena(&keepArenas[1]);
+
+	keepArena = NULL;
+}
+
+void resetFrameArenas(void)
+{
+	METRIC_SET(METRIC_FRAME_ARENA_BYTES, frameArena.used);
+	METRIC_SET(METRIC_FRAME_ARENA_PEAK, frameArena.peak);
+
+	arenaReset(&frameArena);
+
+	// The other keep arena holds last frame's data; this one's contents are two frames old.
+	keepArena = &keepArenas[app.frame & 1];
+	arenaReset(keepArena);
+}
+
+void *frameAlloc(size_t size)
+{
+	return arenaAlloc(&frameArena, size);
+}
+
+void *frameAllocKeep(size_t size)
+{
+	return arenaAlloc(keepArena, size);
+}
+
+char *frameFormat(const char *format, ...)
+{
+	va_list args;
+	char *text;
+
+	va_start(args, format);
+	text = arenaFormat(&frameArena, format, args);
+	va_end(args);
+
+	return text;
+}
+
+char *frameFormatV(const char *format, va_list args)
+{
+	return arenaFormat(&frameArena, format, args);
+}
@@ -0,0 +1,17 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+void initArena(Arena *arena, const char *name, size_t size);
+void destroyArena(Arena *arena);
+void *arenaAlloc(Arena *arena, size_t size);
+char *arenaFormat(Arena *arena, const char *format, va_list args);
+void arenaReset(Arena *arena);
+
+void initFrameArenas(void);
+void shutdownFrameArenas(void);
+void resetFrameArenas(void);
+void *frameAlloc(size_t size);
+void *frameAllocKeep(size_t size);
+char *frameFormat(const char *format, ...);
+char *frameFormatV(const char *format, va_list args);
@@ -5,12 +5,14 @@ Copyright (C) 2023-2025 Asephri.net. All rights reserved.
 #include "common.h"
 #include "background.h"
 #include "draw.h"
+#include "texture.h"
+#include "render.h"
 
 extern App app;
 
 static int backgroundX;
 static Star stars[MAX_STARS];
-static SDL_Texture *background;
+static int background;
 
 void initStars(void)
 {
@@ -26,7 +28,7 @@ void initStars(void)
 
 void initBackground(void)
 {
-    background = loadTexture("gfx/background.png");
+    background = requestTexture("gfx/background.png", TEXTURE_SHARED);
     backgroundX = 0;
     
     /*if (background == NULL)
@@ -36,7 +38,7 @@ void initBackground(void)
     else
     {
         // Console message.
-        printf("Background initialized.\n");
+        LOG_INFO(LOG_CAT_RENDER, "Background initialized.");
     }*/
 }
 
@@ -73,9 +75,9 @@ void drawStars(void)
     {
         c = 32 * stars[i].speed;
 
-        SDL_SetRenderDrawColor(app.renderer, c, c, c, 255);
+        setDrawColor(c, c, c, 255);
 
-        SDL_RenderDrawLine(app.renderer, stars[i].x, stars[i].y, stars[i].x + 3, stars[i].y);
+        renderDrawLine(stars[i].x, stars[i].y, stars[i].x + 3, stars[i].y);
     }
     //printf("Stars rendered.\n");
 }
@@ -92,7 +94,7 @@ void drawBackground(void)
         dest.w = SCREEN_WIDTH;
         dest.h = SCREEN_HEIGHT;
 
-        SDL_RenderCopy(app.renderer, background, NULL, &dest);
+        renderCopy(getTexture(background), NULL, &dest);
     }
     //printf("Background rendered.\n");
 }
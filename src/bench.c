@@ -0,0 +1,291 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+#include "common.h"
+#include "bench.h"
+#include "main.h"
+#include "metrics.h"
+#include "render.h"
+#include "stage.h"
+
+extern App app;
+
+typedef struct
+{
+	int frame;
+	int scancode;
+	int pressed;
+} BenchInput;
+
+typedef struct
+{
+	double *samples;
+	double mean;
+	double p50;
+	double p90;
+	double p99;
+	double max;
+} BenchSeries;
+
+static void applyScript(long frame);
+static void summarise(BenchSeries *series, int count);
+static double percentile(double *sorted, int count, double p);
+static int compareSamples(const void *a, const void *b);
+static void writeSeries(FILE *file, const char *name, BenchSeries *series);
+static void writeSamples(FILE *file, const char *name, BenchSeries *series, int count);
+static void writeReport(void);
+
+// Repeats every SCRIPT_LENGTH frames: fire constantly while sweeping the play field.
+static const BenchInput script[] = {
+	{0, SDL_SCANCODE_LCTRL, 1},
+	{0, SDL_SCANCODE_RIGHT, 1},
+	{90, SDL_SCANCODE_RIGHT, 0},
+	{90, SDL_SCANCODE_UP, 1},
+	{180, SDL_SCANCODE_UP, 0},
+	{180, SDL_SCANCODE_DOWN, 1},
+	{360, SDL_SCANCODE_DOWN, 0},
+	{360, SDL_SCANCODE_LEFT, 1},
+	{420, SDL_SCANCODE_LEFT, 0},
+	{420, SDL_SCANCODE_UP, 1},
+	{510, SDL_SCANCODE_UP, 0}
+};
+
+#define SCRIPT_LENGTH 540
+
+static const char *outFilename;
+static const char *scenario;
+static int frames;
+static int warmup;
+static int seed;
+static int restarts;
+static BenchSeries frameSeries;
+static BenchSeries logicSeries;
+static BenchSeries drawSeries;
+
+int initBenchmark(int argc, char *argv[])
+{
+	int i, enabled;
+
+	enabled = 0;
+	outFilename = BENCHMARK_FILENAME;
+	scenario = BENCHMARK_SCENARIO;
+	frames = BENCHMARK_FRAMES;
+	warmup = BENCHMARK_WARMUP;
+	seed = BENCHMARK_SEED;
+
+	for (i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--benchmark") == 0)
+		{
+			enabled = 1;
+		}
+		else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+		{
+			frames = atoi(argv[++i]);
+			frames = MAX(1, frames);
+		}
+		else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc)
+		{
+			warmup = atoi(argv[++i]);
+			warmup = MAX(0, warmup);
+		}
+		else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+		{
+			seed = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--scenario") == 0 && i + 1 < argc)
+		{
+			scenario = argv[++i];
+		}
+		else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+		{
+			outFilename = argv[++i];
+		}
+	}
+
+	if (!enabled)
+	{
+		return 0;
+	}
+
+	// No display or sound card on the build servers.
+	SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+	SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+
+	srand(seed);
+
+	LOG_INFO(LOG_CAT_APP, "Benchmark mode: scenario '%s', %d frames (+%d warmup), seed %d.", scenario, frames, warmup, seed);
+
+	return 1;
+}
+
+void runBenchmark(void)
+{
+	void (*stageLogic)(void);
+	long i, total;
+	int n;
+
+	frameSeries.samples = malloc(sizeof(double) * frames);
+	logicSeries.samples = malloc(sizeof(double) * frames);
+	drawSeries.samples = malloc(sizeof(double) * frames);
+
+	restarts = 0;
+	total = warmup + frames;
+
+	initStage();
+	stageLogic = app.delegate.logic;
+
+	for (i = 0; i < total; i++)
+	{
+		applyScript(i);
+
+		if (i == warmup)
+		{
+			resetRenderTotals();
+		}
+
+		doFrame();
+
+		if (i >= warmup)
+		{
+			n = i - warmup;
+			frameSeries.samples[n] = app.frameTimes.frame;
+			logicSeries.samples[n] = app.frameTimes.logic;
+			drawSeries.samples[n] = app.frameTimes.draw;
+		}
+
+		// The player died and the stage handed over to the highscore screen; keep measuring gameplay.
+		if (app.delegate.logic != stageLogic)
+		{
+			restarts++;
+			initStage();
+		}
+	}
+
+	writeReport();
+
+	free(frameSeries.samples);
+	free(logicSeries.samples);
+	free(drawSeries.samples);
+}
+
+static void applyScript(long frame)
+{
+	int i, t;
+
+	t = frame % SCRIPT_LENGTH;
+
+	for (i = 0; i < sizeof(script) / sizeof(BenchInput); i++)
+	{
+		if (script[i].frame == t)
+		{
+			app.keyboard[script[i].scancode] = script[i].pressed;
+		}
+	}
+}
+
+static void summarise(BenchSeries *series, int count)
+{
+	double *sorted, sum;
+	int i;
+
+	sorted = malloc(sizeof(double) * count);
+	memcpy(sorted, series->samples, sizeof(double) * count);
+	qsort(sorted, count, sizeof(double), compareSamples);
+
+	sum = 0;
+	for (i = 0; i < count; i++)
+	{
+		sum += sorted[i];
+	}
+
+	series->mean = sum / count;
+	series->p50 = percentile(sorted, count, 50);
+	series->p90 = percentile(sorted, count, 90);
+	series->p99 = percentile(sorted, count, 99);
+	series->max = sorted[count - 1];
+
+	free(sorted);
+}
+
+static double percentile(double *sorted, int count, double p)
+{
+	int rank;
+
+	// Nearest-rank percentile.
+	rank = (int)ceil(p / 100.0 * count) - 1;
+	rank = MAX(0, MIN(count - 1, rank));
+
+	return sorted[rank];
+}
+
+static int compareSamples(const void *a, const void *b)
+{
+	double d1 = *(const double *)a;
+	double d2 = *(const double *)b;
+
+	return (d1 > d2) - (d1 < d2);
+}
+
+static void writeSeries(FILE *file, const char *name, BenchSeries *series)
+{
+	fprintf(file, "  \"%s\": {\"mean\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"max\": %.4f},\n",
+		name, series->mean, series->p50, series->p90, series->p99, series->max);
+}
+
+static void writeSamples(FILE *file, const char *name, BenchSeries *series, int count)
+{
+	int i;
+
+	fprintf(file, "    \"%s\": [", name);
+
+	for (i = 0; i < count; i++)
+	{
+		fprintf(file, "%s%.4f", (i > 0) ? ", " : "", series->samples[i]);
+	}
+
+	fprintf(file, "]");
+}
+
+static void writeReport(void)
+{
+	FILE *file;
+
+	summarise(&frameSeries, frames);
+	summarise(&logicSeries, frames);
+	summarise(&drawSeries, frames);
+
+	file = fopen(outFilename, "w");
+	if (file == NULL)
+	{
+		LOG_ERROR(LOG_CAT_APP, "Couldn't write benchmark report %s.", outFilename);
+		return;
+	}
+
+	fprintf(file, "{\n");
+	fprintf(file, "  \"scenario\": \"%s\",\n", scenario);
+	fprintf(file, "  \"seed\": %d,\n", seed);
+	fprintf(file, "  \"frames\": %d,\n", frames);
+	fprintf(file, "  \"warmup\": %d,\n", warmup);
+	fprintf(file, "  \"restarts\": %d,\n", restarts);
+	fprintf(file, "  \"unit\": \"ms\",\n");
+	fprintf(file, "  \"heapPeakBytes\": %ld,\n", metrics[METRIC_HEAP_PEAK]);
+	fprintf(file, "  \"allocations\": %ld,\n", metrics[METRIC_ALLOCS]);
+	writeRenderReport(file);
+	writeSeries(file, "frame", &frameSeries);
+	writeSeries(file, "logic", &logicSeries);
+	writeSeries(file, "draw", &drawSeries);
+	fprintf(file, "  \"samples\": {\n");
+	writeSamples(file, "frame", &frameSeries, frames);
+	fprintf(file, ",\n");
+	writeSamples(file, "logic", &logicSeries, frames);
+	fprintf(file, ",\n");
+	writeSamples(file, "draw", &drawSeries, frames);
+	fprintf(file, "\n  }\n}\n");
+
+	fclose(file);
+
+	LOG_INFO(LOG_CAT_APP, "Benchmark frame time p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, max %.3f ms. Report written to %s.",
+		frameSeries.p50, frameSeries.p90, frameSeries.p99, frameSeries.max, outFilename);
+}
@@ -0,0 +1,6 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+int initBenchmark(int argc, char *argv[]);
+void runBenchmark(void);
@@ -4,6 +4,7 @@ Copyright (C) 2023-2025 Asephri.net. All rights reserved.
 
 #include "ctype.h"
 #include "defs.h"
+#include "log.h"
 #include "math.h"
 #include "SDL2/SDL.h"
 #include "stdio.h"
@@ -17,9 +17,43 @@ dest[n - 1] = '\0'
 #define SCREEN_WIDTH  1024
 #define SCREEN_HEIGHT 736 + HUD_HEIGHT
 #define MAX_SCORE_NAME_LENGTH 8
-#define MAX_NAME_LENGTH 8
 #define MAX_LINE_LENGTH 1024
 
+// Texture registry: handles index a fixed array; the hash table must stay a power of two of at least twice that.
+#define MAX_TEXTURES 128
+#define TEXTURE_HASH_SIZE 256
+
+// Owner bit for textures every scene draws (font, HUD effects, background); never released.
+#define TEXTURE_SHARED 31
+
+// Resident texture memory before unreferenced textures are evicted, in MB; 0 disables eviction.
+// --texture-budget MB overrides it at run time.
+#ifndef TEXTURE_BUDGET_MB
+#define TEXTURE_BUDGET_MB 64
+#endif
+
+// Storage format textures are converted to before upload: "full" keeps the decoded 32-bit
+// surface, "rgb565", "argb4444" and "argb1555" halve it. --texture-format NAME overrides it
+// at run time; lines of "path format" in TEXTURE_FORMATS_FILENAME override it per texture.
+#ifndef TEXTURE_FORMAT
+#define TEXTURE_FORMAT "full"
+#endif
+#define TEXTURE_FORMATS_FILENAME "gfx/formats.txt"
+#define MAX_TEXTURE_FORMAT_RULES 64
+
+// A compact conversion below this PSNR (dB, over RGBA) is rejected and the texture kept at full format.
+#define TEXTURE_PSNR_MIN 30.0
+
+// Baked by tools/packbake at build time; --pack FILE or --no-pack at run time.
+#define PACK_FILENAME "voidfighter.pak"
+
+// Mixer device format. tools/packbake bakes sound effects to the same one.
+#define AUDIO_FREQUENCY 44100
+#define AUDIO_CHANNELS 2
+#define AUDIO_CHUNK_SIZE 1024
+
+#define POINTS_TEXTURES 11
+
 #define FPS 60
 
 #define PLAYER_HEALTH 25
@@ -88,3 +122,238 @@ enum
 #define ENEMY_SPAWN_TIME 30
 
 #define AMMUNITION 16
+
+// Scene timers, in frames.
+#define STAGE_OVER_DELAY (FPS * 3)
+#define TITLE_TIMEOUT (FPS * 5)
+#define TITLE_TIMEOUT_GRACE 80
+#define HIGHSCORES_TIMEOUT 500
+
+#define LOG_LEVEL_TRACE 0
+#define LOG_LEVEL_DEBUG 1
+#define LOG_LEVEL_INFO  2
+#define LOG_LEVEL_WARN  3
+#define LOG_LEVEL_ERROR 4
+#define LOG_LEVEL_NONE  5
+
+// Messages below this level are compiled out entirely. Override with -DLOG_COMPILE_LEVEL=n.
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_LEVEL_INFO
+#endif
+
+#define LOG_FILENAME "consolelog.txt"
+#define LOG_RING_SIZE 4096
+#define LOG_MESSAGE_LENGTH 192
+#define LOG_MAX_FILE_SIZE (4 * 1024 * 1024)
+#define LOG_MAX_FILES 3
+#define LOG_DRAIN_INTERVAL 10
+
+enum LogCategory
+{
+	LOG_CAT_APP,
+	LOG_CAT_STAGE,
+	LOG_CAT_COLLISION,
+	LOG_CAT_INPUT,
+	LOG_CAT_SOUND,
+	LOG_CAT_RENDER,
+	LOG_CAT_SDL,
+	LOG_CAT_MAX
+};
+
+#define PROFILE_FILENAME "voidfighter_trace.json"
+#define PROFILE_MAX_EVENTS 262144
+#define PROFILE_MAX_DEPTH 32
+
+#define BENCHMARK_FILENAME "benchmark.json"
+#define BENCHMARK_SCENARIO "stage"
+#define BENCHMARK_FRAMES 3600
+#define BENCHMARK_WARMUP 60
+#define BENCHMARK_SEED 1
+
+#define METRICS_SOCKET "voidfighter-metrics.sock"
+#define METRICS_INTERVAL 300
+#define METRICS_BUFFER_SIZE 8192
+
+enum Metric
+{
+	METRIC_FIGHTERS,
+	METRIC_BULLETS,
+	METRIC_EXPLOSIONS,
+	METRIC_DEBRIS,
+	METRIC_TRAILS,
+	METRIC_FIRE,
+	METRIC_POINTS,
+	METRIC_SPAWNS,
+	METRIC_FREES,
+	METRIC_COLLISION_TESTS,
+	METRIC_SOUNDS,
+	METRIC_TEXTURE_LOOKUPS,
+	METRIC_TEXTURE_MISSES,
+	METRIC_FRAMES,
+	METRIC_FRAME_TIME,
+	METRIC_LOGIC_TIME,
+	METRIC_DRAW_TIME,
+	METRIC_HEAP_BYTES,
+	METRIC_HEAP_PEAK,
+	METRIC_ALLOCS,
+	METRIC_DRAW_CALLS,
+	METRIC_STATE_CHANGES,
+	METRIC_TEXTURE_SWITCHES,
+	METRIC_PIXELS,
+	METRIC_POOL_EXHAUSTED,
+	METRIC_FRAME_ARENA_BYTES,
+	METRIC_FRAME_ARENA_PEAK,
+	METRIC_TIMERS,
+	METRIC_TIMERS_FIRED,
+	METRIC_TEXTURE_BYTES,
+	METRIC_TEXTURE_EVICTIONS,
+	METRIC_LOADS_PENDING,
+	METRIC_COLLISION_HITS,
+	METRIC_CONTACTS,
+	METRIC_CONTACT_EFFECTS,
+	METRIC_MASK_REJECTS,
+	METRIC_SWEPT_HITS,
+	METRIC_MAX
+};
+
+#define OVERLAY_KEY SDL_SCANCODE_F3
+#define OVERLAY_HISTORY 240
+#define OVERLAY_X 8
+#define OVERLAY_Y 40
+#define OVERLAY_GRAPH_HEIGHT 80
+#define OVERLAY_GRAPH_SCALE 2
+
+#define RECORDER_FRAMES (FPS * 5)
+#define RECORDER_BUDGET_MS 16.0
+#define RECORDER_MAX_DUMPS 32
+
+enum Scene
+{
+	SCENE_TITLE,
+	SCENE_STAGE,
+	SCENE_HIGHSCORES
+};
+
+#define SAMPLER_FILENAME "voidfighter.folded"
+#define SAMPLER_HZ 997
+#define SAMPLER_MAX_HZ 10000
+#define SAMPLER_MAX_SAMPLES (1 << 20)
+
+enum Phase
+{
+	PHASE_INIT,
+	PHASE_PREPARE,
+	PHASE_INPUT,
+	PHASE_LOGIC,
+	PHASE_DRAW,
+	PHASE_OVERLAY,
+	PHASE_PRESENT,
+	PHASE_WAIT,
+	PHASE_MAX
+};
+
+enum MemTag
+{
+	MEM_TAG_SDL,
+	MEM_TAG_TEXTURES,
+	MEM_TAG_AUDIO,
+	MEM_TAG_POOLS,
+	MEM_TAG_MAX
+};
+
+#define RENDER_MAX_PHASES 32
+
+// Asset loader: up to LOADER_MAX_THREADS workers (one fewer than the CPUs) decode; the main thread uploads
+// at most LOADER_UPLOADS_PER_FRAME finished textures per frame.
+#define LOADER_MAX_THREADS 4
+#define MAX_LOAD_JOBS 128
+#define LOADER_UPLOADS_PER_FRAME 4
+
+enum LoadState
+{
+	LOAD_FREE,
+	LOAD_QUEUED,
+	LOAD_RUNNING,
+	LOAD_DONE
+};
+
+#define STARTUP_FILENAME "voidfighter_startup.json"
+#define STARTUP_MAX_SPANS 512
+#define STARTUP_MAX_DEPTH 16
+
+// Entity components; an archetype stores the set given to initArchetype().
+#define COMP_TRANSFORM 1
+#define COMP_VELOCITY 2
+#define COMP_SPRITE 4
+#define COMP_HEALTH 8
+#define COMP_RELOAD 16
+#define COMP_SIDE 32
+#define COMP_EXPIRY 64
+
+#define ENTITY_NONE 0
+
+// Archetype capacities; override with -D at build time. A full archetype drops the spawn and counts it.
+#ifndef ARCHETYPE_FIGHTERS
+#define ARCHETYPE_FIGHTERS 256
+#endif
+#ifndef ARCHETYPE_BULLETS
+#define ARCHETYPE_BULLETS 2048
+#endif
+#ifndef ARCHETYPE_POINTS
+#define ARCHETYPE_POINTS 256
+#endif
+
+// Timing wheel: TIMER_LEVELS wheels of 2^TIMER_WHEEL_BITS slots, one tick per frame, so delays up to 2^24 frames.
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+#define TIMER_LEVELS 4
+
+#ifndef POOL_TIMERS
+#define POOL_TIMERS 1024
+#endif
+
+// Particle flags: GLOW particles are tinted, additive and fade out with their life; the rest draw a source rect.
+#define PARTICLE_GLOW 1
+
+#ifndef PARTICLES_EXPLOSIONS
+#define PARTICLES_EXPLOSIONS 32768
+#endif
+#ifndef PARTICLES_DEBRIS
+#define PARTICLES_DEBRIS 8192
+#endif
+#ifndef PARTICLES_TRAILS
+#define PARTICLES_TRAILS 8192
+#endif
+#ifndef PARTICLES_FIRE
+#define PARTICLES_FIRE 8192
+#endif
+
+// Collision broadphase: a uniform grid of GRID_CELL_SIZE cells over the play field, one set of buckets per side.
+// Anything outside the field is clamped into the border cells.
+#define GRID_CELL_SIZE 64
+#define GRID_COLS ((HUDSCREEN_WIDTH + GRID_CELL_SIZE - 1) / GRID_CELL_SIZE)
+#define GRID_ROWS ((HUDSCREEN_HEIGHT + GRID_CELL_SIZE - 1) / GRID_CELL_SIZE)
+#define GRID_SIDES 2
+#define GRID_BUCKETS (GRID_COLS * GRID_ROWS * GRID_SIDES)
+
+// Collision contacts are recorded during detection and resolved once at the end of the stage's logic.
+// Hits whose positions fall in the same CONTACT_MERGE_SIZE cell share one burst of effects.
+enum ContactKind
+{
+	CONTACT_BULLET,
+	CONTACT_CRASH
+};
+
+#define CONTACT_MERGE_SIZE 16
+#define CRASH_EXPLOSIONS (4 * 77)
+
+// blit() stretches every sprite to SPRITE_DRAW_SIZE square. Sprites no bigger than that get a
+// pixel mask at the drawn size, one 64-bit word per row, so it can't exceed 64.
+// A pixel is solid from COLLISION_ALPHA alpha up; softer edges never register a hit.
+#define SPRITE_DRAW_SIZE 64
+#define COLLISION_MASK_SIZE SPRITE_DRAW_SIZE
+#define COLLISION_ALPHA 128
+
+#define FRAME_ARENA_SIZE (256 * 1024)
+#define KEEP_ARENA_SIZE (64 * 1024)
+#define ARENA_ALIGN 16
@@ -0,0 +1,324 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+#include "common.h"
+#include "entity.h"
+#include "memtrack.h"
+#include "metrics.h"
+#include "util.h"
+
+// A handle is a slot index plus the slot's generation, so a handle kept past a despawn
+// (or past the slot being reused) resolves to nothing instead of to some other entity.
+#define ENTITY_INDEX_BITS 20
+#define ENTITY_INDEX_MASK ((1U << ENTITY_INDEX_BITS) - 1)
+#define ENTITY_GENERATION_MASK (0xffffffffU >> ENTITY_INDEX_BITS)
+
+typedef struct
+{
+	Archetype *archetype;
+	int row;
+	int next;
+	Uint32 generation;
+} EntitySlot;
+
+static void *allocColumn(Archetype *archetype, int component, size_t size);
+
+static EntitySlot *slots;
+static int slotCount;
+static int freeSlot;
+
+void initEntities(int capacity)
+{
+	int i;
+
+	// One extra slot: slot 0 is never handed out, so ENTITY_NONE can't alias a live entity.
+	capacity++;
+
+	if (capacity > (int)ENTITY_INDEX_MASK)
+	{
+		LOG_ERROR(LOG_CAT_STAGE, "Entity capacity %d exceeds the %d a handle can address.", capacity, (int)ENTITY_INDEX_MASK);
+		exit(1);
+	}
+
+	slots = memAlloc(sizeof(EntitySlot) * capacity, MEM_TAG_POOLS);
+
+	if (slots == NULL)
+	{
+		LOG_ERROR(LOG_CAT_STAGE, "Couldn't allocate %d entity slots.", capacity);
+		exit(1);
+	}
+
+	for (i = 0; i < capacity; i++)
+	{
+		slots[i].archetype = NULL;
+		slots[i].row = -1;
+		slots[i].next = i + 1;
+		slots[i].generation = 1;
+	}
+
+	slots[capacity - 1].next = -1;
+	slotCount = capacity;
+	freeSlot = 1;
+}
+
+void destroyEntities(void)
+{
+	memFree(slots);
+
+	slots = NULL;
+	slotCount = 0;
+	freeSlot = -1;
+}
+
+void initArchetype(Archetype *archetype, const char *name, int components, int capacity, int metric)
+{
+	memset(archetype, 0, sizeof(Archetype));
+
+	archetype->name = name;
+	archetype->components = components;
+	archetype->capacity = capacity;
+	archetype->metric = metric;
+
+	archetype->id = allocColumn(archetype, 0, sizeof(EntityId));
+	archetype->transform = allocColumn(archetype, COMP_TRANSFORM, sizeof(Transform));
+	archetype->velocity = allocColumn(archetype, COMP_VELOCITY, sizeof(Velocity));
+	archetype->sprite = allocColumn(archetype, COMP_SPRITE, sizeof(int));
+	archetype->health = allocColumn(archetype, COMP_HEALTH, sizeof(int));
+	archetype->reload = allocColumn(archetype, COMP_RELOAD, sizeof(int));
+	archetype->side = allocColumn(archetype, COMP_SIDE, sizeof(int));
+	archetype->expires = allocColumn(archetype, COMP_EXPIRY, sizeof(Uint32));
+
+	LOG_INFO(LOG_CAT_STAGE, "Archetype '%s': %d entities, components 0x%02x.", name, capacity, components);
+}
+
+void destroyArchetype(Archetype *archetype)
+{
+	if (archetype->id != NULL)
+	{
+		LOG_INFO(LOG_CAT_STAGE, "Archetype '%s': %ld spawns dropped at capacity.", archetype->name, archetype->dropped);
+	}
+
+	memFree(archetype->id);
+	memFree(archetype->transform);
+	memFree(archetype->velocity);
+	memFree(archetype->sprite);
+	memFree(archetype->health);
+	memFree(archetype->reload);
+	memFree(archetype->side);
+	memFree(archetype->expires);
+
+	memset(archetype, 0, sizeof(Archetype));
+}
+
+int spawnEntity(Archetype *archetype, EntityId *id)
+{
+	EntitySlot *slot;
+	int index, row;
+
+	if (archetype->count >= archetype->capacity || freeSlot < 0)
+	{
+		// Callers drop the spawn.
+		archetype->dropped++;
+		METRIC_ADD(METRIC_POOL_EXHAUSTED, 1);
+
+		if (shouldWarn(archetype->dropped))
+		{
+			LOG_WARN(LOG_CAT_STAGE, "Archetype '%s' full (%d live), %ld spawns dropped so far.", archetype->name, archetype->count, archetype->dropped);
+		}
+
+		return -1;
+	}
+
+	index = freeSlot;
+	slot = &slots[index];
+	freeSlot = slot->next;
+
+	row = archetype->count++;
+
+	slot->archetype = archetype;
+	slot->row = row;
+
+	archetype->id[row] = (slot->generation << ENTITY_INDEX_BITS) | index;
+
+	if (archetype->transform != NULL)
+	{
+		memset(&archetype->transform[row], 0, sizeof(Transform));
+	}
+
+	if (archetype->velocity != NULL)
+	{
+		memset(&archetype->velocity[row], 0, sizeof(Velocity));
+	}
+
+	if (archetype->sprite != NULL)
+	{
+		archetype->sprite[row] = 0;
+	}
+
+	if (archetype->health != NULL)
+	{
+		archetype->health[row] = 0;
+	}
+
+	if (archetype->reload != NULL)
+	{
+		archetype->reload[row] = 0;
+	}
+
+	if (archetype->side != NULL)
+	{
+		archetype->side[row] = 0;
+	}
+
+	if (archetype->expires != NULL)
+	{
+		archetype->expires[row] = 0;
+	}
+
+	METRIC_ADD(archetype->metric, 1);
+	METRIC_ADD(METRIC_SPAWNS, 1);
+
+	if (id != NULL)
+	{
+		*id = archetype->id[row];
+	}
+
+	return row;
+}
+
+void despawnEntity(Archetype *archetype, int row)
+{
+	EntitySlot *slot;
+	int index, last;
+
+	index = archetype->id[row] & ENTITY_INDEX_MASK;
+	slot = &slots[index];
+
+	// Bumping the generation is what invalidates every outstanding handle to this entity.
+	slot->generation = (slot->generation + 1) & ENTITY_GENERATION_MASK;
+	if (slot->generation == 0)
+	{
+		slot->generation = 1;
+	}
+
+	slot->archetype = NULL;
+	slot->row = -1;
+	slot->next = freeSlot;
+	freeSlot = index;
+
+	// Swap-remove: the last row fills the hole, so the next row to visit is the same index again.
+	last = --archetype->count;
+
+	if (row != last)
+	{
+		archetype->id[row] = archetype->id[last];
+		slots[archetype->id[row] & ENTITY_INDEX_MASK].row = row;
+
+		if (archetype->transform != NULL)
+		{
+			archetype->transform[row] = archetype->transform[last];
+		}
+
+		if (archetype->velocity != NULL)
+		{
+			archetype->velocity[row] = archetype->velocity[last];
+		}
+
+		if (archetype->sprite != NULL)
+		{
+			archetype->sprite[row] = archetype->sprite[last];
+		}
+
+		if (archetype->health != NULL)
+		{
+			archetype->health[row] = archetype->health[last];
+		}
+
+		if (archetype->reload != NULL)
+		{
+			archetype->reload[row] = archetype->reload[last];
+		}
+
+		if (archetype->side != NULL)
+		{
+			archetype->side[row] = archetype->side[last];
+		}
+
+		if (archetype->expires != NULL)
+		{
+			archetype->expires[row] = archetype->expires[last];
+		}
+	}
+
+	METRIC_ADD(archetype->metric, -1);
+	METRIC_ADD(METRIC_FREES, 1);
+}
+
+void clearArchetype(Archetype *archetype)
+{
+	// Walk from the back so every despawn is the cheap last-row case; each one still has to retire its handle.
+	while (archetype->count > 0)
+	{
+		despawnEntity(archetype, archetype->count - 1);
+	}
+}
+
+int countEntities(void)
+{
+	int i, live;
+
+	live = 0;
+
+	for (i = 1; i < slotCount; i++)
+	{
+		if (slots[i].archetype != NULL)
+		{
+			live++;
+		}
+	}
+
+	return live;
+}
+
+int entityRow(EntityId id, const Archetype *archetype)
+{
+	EntitySlot *slot;
+	int index;
+
+	index = id & ENTITY_INDEX_MASK;
+
+	if (id == ENTITY_NONE || index >= slotCount)
+	{
+		return -1;
+	}
+
+	slot = &slots[index];
+
+	if (slot->archetype != archetype || slot->generation != (id >> ENTITY_INDEX_BITS))
+	{
+		return -1;
+	}
+
+	return slot->row;
+}
+
+static void *allocColumn(Archetype *archetype, int component, size_t size)
+{
+	void *column;
+
+	if (component != 0 && !(archetype->components & component))
+	{
+		return NULL;
+	}
+
+	column = memAlloc(size * archetype->capacity, MEM_TAG_POOLS);
+
+	if (column == NULL)
+	{
+		LOG_ERROR(LOG_CAT_STAGE, "Couldn't allocate archetype '%s'.", archetype->name);
+		exit(1);
+	}
+
+	return column;
+}
@@ -0,0 +1,13 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+void initEntities(int capacity);
+void destroyEntities(void);
+void initArchetype(Archetype *archetype, const char *name, int components, int capacity, int metric);
+void destroyArchetype(Archetype *archetype);
+int spawnEntity(Archetype *archetype, EntityId *id);
+void despawnEntity(Archetype *archetype, int row);
+void clearArchetype(Archetype *archetype);
+int countEntities(void);
+int entityRow(EntityId id, const Archetype *archetype);
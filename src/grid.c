@@ -0,0 +1,453 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+#include "common.h"
+#include "aabb.h"
+#include "grid.h"
+#include "mask.h"
+#include "memtrack.h"
+#include "metrics.h"
+#include "texture.h"
+
+// Broadphase for the stage's collision tests. buildGrid() counting-sorts an archetype's rows
+// into (side, cell) buckets in two passes over the rows, with no per-frame allocation, and lays
+// their bounds out in the same order. overlapGrid() takes the cells under the query rect
+// widened by the largest half-size in the grid, which are one run of buckets per grid row,
+// and hands each run to the batch narrowphase in aabb.c as it lies. Rows are only valid until
+// the archetype next spawns or despawns.
+//
+// Boxes are hitboxes: the tight box around the sprite's opaque pixels, at the whole pixels it
+// is drawn at. Where both sides have a mask, a box overlap only counts if the masks touch.
+//
+// sweepGrid() is for things that move further in a tick than they are wide. It tests the whole
+// path of the last step instead of where it ended, so a hit can't be stepped over.
+
+static const CollisionMask *hitbox(const Transform *t, int sprite, float *box);
+static int firstTouch(const CollisionMask *mask, const Transform *t, float dx, float dy, const CollisionMask *other, const Transform *o, float enter, float leave, float *time);
+static float nextPixel(float p, float d, float s);
+static int cellOf(float v, int cells);
+static float *allocColumn(SpatialGrid *grid);
+
+void initCollision(int argc, char *argv[])
+{
+	const char *name;
+	int i;
+
+	name = NULL;
+
+	for (i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--aabb-kernel") == 0 && i + 1 < argc)
+		{
+			name = argv[++i];
+		}
+	}
+
+	if (name != NULL && selectAabbKernel(name) == NULL)
+	{
+		LOG_WARN(LOG_CAT_COLLISION, "Collision kernel '%s' is unknown or unsupported on this CPU.", name);
+		name = NULL;
+	}
+
+	if (name == NULL)
+	{
+		selectAabbKernel(NULL);
+	}
+
+	LOG_INFO(LOG_CAT_COLLISION, "Collision kernel: %s.", getAabbKernel());
+}
+
+void initGrid(SpatialGrid *grid, const char *name, const Archetype *archetype)
+{
+	memset(grid, 0, sizeof(SpatialGrid));
+
+	grid->name = name;
+	grid->archetype = archetype;
+	grid->rows = memAlloc(sizeof(int) * archetype->capacity, MEM_TAG_POOLS);
+	grid->found = memAlloc(sizeof(int) * archetype->capacity, MEM_TAG_POOLS);
+	grid->times = allocColumn(grid);
+	grid->boxes.minX = allocColumn(grid);
+	grid->boxes.minY = allocColumn(grid);
+	grid->boxes.maxX = allocColumn(grid);
+	grid->boxes.maxY = allocColumn(grid);
+
+	if (grid->rows == NULL || grid->found == NULL)
+	{
+		LOG_ERROR(LOG_CAT_COLLISION, "Couldn't allocate grid '%s'.", name);
+		exit(1);
+	}
+
+	LOG_INFO(LOG_CAT_COLLISION, "Grid '%s': %dx%d cells of %d px, %d sides.", name, GRID_COLS, GRID_ROWS, GRID_CELL_SIZE, GRID_SIDES);
+}
+
+void destroyGrid(SpatialGrid *grid)
+{
+	if (grid->rows != NULL && grid->queries > 0)
+	{
+		LOG_INFO(LOG_CAT_COLLISION, "Grid '%s': %ld queries, %.2f candidates per query.", grid->name, grid->queries, (double)grid->candidates / grid->queries);
+	}
+
+	memFree(grid->rows);
+	memFree(grid->found);
+	memFree(grid->times);
+	memFree(grid->boxes.minX);
+	memFree(grid->boxes.minY);
+	memFree(grid->boxes.maxX);
+	memFree(grid->boxes.maxY);
+
+	memset(grid, 0, sizeof(SpatialGrid));
+}
+
+void buildGrid(SpatialGrid *grid)
+{
+	const Archetype *archetype;
+	float box[4];
+	int *key;
+	int i, side, slot, sprite;
+
+	archetype = grid->archetype;
+	key = grid->found;
+
+	memset(grid->start, 0, sizeof(grid->start));
+	grid->padW = 0;
+	grid->padH = 0;
+	grid->moveX = 0;
+	grid->moveY = 0;
+
+	for (i = 0; i < archetype->count; i++)
+	{
+		sprite = (archetype->sprite != NULL) ? archetype->sprite[i] : 0;
+		side = (archetype->side != NULL) ? archetype->side[i] : 0;
+
+		hitbox(&archetype->transform[i], sprite, box);
+
+		key[i] = (side * GRID_ROWS + cellOf((box[1] + box[3]) / 2, GRID_ROWS)) * GRID_COLS + cellOf((box[0] + box[2]) / 2, GRID_COLS);
+		grid->start[key[i]]++;
+
+		grid->padW = MAX(grid->padW, ((int)(box[2] - box[0]) + 1) / 2);
+		grid->padH = MAX(grid->padH, ((int)(box[3] - box[1]) + 1) / 2);
+
+		if (archetype->velocity != NULL)
+		{
+			grid->moveX = MAX(grid->moveX, fabsf(archetype->velocity[i].dx));
+			grid->moveY = MAX(grid->moveY, fabsf(archetype->velocity[i].dy));
+		}
+	}
+
+	// Running totals leave start[k] at the end of bucket k; placing rows back to front walks it
+	// down to the bucket's first slot and keeps each bucket in row order.
+	for (i = 1; i < GRID_BUCKETS; i++)
+	{
+		grid->start[i] += grid->start[i - 1];
+	}
+
+	grid->start[GRID_BUCKETS] = archetype->count;
+
+	for (i = archetype->count - 1; i >= 0; i--)
+	{
+		sprite = (archetype->sprite != NULL) ? archetype->sprite[i] : 0;
+		slot = --grid->start[key[i]];
+
+		hitbox(&archetype->transform[i], sprite, box);
+
+		grid->rows[slot] = i;
+		grid->boxes.minX[slot] = box[0];
+		grid->boxes.minY[slot] = box[1];
+		grid->boxes.maxX[slot] = box[2];
+		grid->boxes.maxY[slot] = box[3];
+	}
+
+	grid->count = archetype->count;
+	grid->boxes.count = archetype->count;
+}
+
+int overlapGrid(SpatialGrid *grid, int side, const Transform *t, int sprite)
+{
+	const Archetype *archetype;
+	const CollisionMask *mask, *other;
+	const Transform *o;
+	AabbBatch run;
+	float query[4];
+	int x0, y0, x1, y1, cy, bucket, first, i, n, tested, row, kept;
+
+	archetype = grid->archetype;
+	mask = hitbox(t, sprite, query);
+
+	x0 = cellOf(query[0] - grid->padW, GRID_COLS);
+	y0 = cellOf(query[1] - grid->padH, GRID_ROWS);
+	x1 = cellOf(query[2] + grid->padW, GRID_COLS);
+	y1 = cellOf(query[3] + grid->padH, GRID_ROWS);
+
+	n = 0;
+	tested = 0;
+
+	for (cy = y0; cy <= y1; cy++)
+	{
+		// Adjacent cells of a grid row are adjacent buckets, so x0..x1 is one run.
+		bucket = (side * GRID_ROWS + cy) * GRID_COLS;
+		first = grid->start[bucket + x0];
+
+		run.minX = grid->boxes.minX + first;
+		run.minY = grid->boxes.minY + first;
+		run.maxX = grid->boxes.maxX + first;
+		run.maxY = grid->boxes.maxY + first;
+		run.count = grid->start[bucket + x1 + 1] - first;
+
+		if (run.count == 0)
+		{
+			continue;
+		}
+
+		tested += run.count;
+
+		// Hits come back as run indices; turn them into archetype rows in place.
+		for (i = n, n += overlapAabbs(&run, query, grid->found + n); i < n; i++)
+		{
+			grid->found[i] = grid->rows[first + grid->found[i]];
+		}
+	}
+
+	// Box hits are rare, so the mask test runs on a handful of rows at most.
+	if (mask != NULL && archetype->sprite != NULL)
+	{
+		for (i = 0, kept = 0; i < n; i++)
+		{
+			row = grid->found[i];
+			o = &archetype->transform[row];
+			other = getCollisionMask(archetype->sprite[row]);
+
+			if (other == NULL || masksOverlap(mask, (int)t->x, (int)t->y, other, (int)o->x, (int)o->y))
+			{
+				grid->found[kept++] = row;
+			}
+		}
+
+		METRIC_ADD(METRIC_MASK_REJECTS, n - kept);
+
+		n = kept;
+	}
+
+	grid->queries++;
+	grid->candidates += tested;
+
+	METRIC_ADD(METRIC_COLLISION_TESTS, tested);
+	METRIC_ADD(METRIC_COLLISION_HITS, n);
+
+	return n;
+}
+
+// The sprite at t got there by moving v this tick. Each row it is tested against is taken back
+// along its own velocity too, so the sweep follows their relative motion. Returns the rows it
+// touched at any point of the tick; times[k] is when found[k] was first touched, from 0 at
+// the start of the tick to 1 at the end.
+int sweepGrid(SpatialGrid *grid, int side, const Transform *t, int sprite, const Velocity *v)
+{
+	const Archetype *archetype;
+	const CollisionMask *mask, *other;
+	AabbBatch run;
+	float box[4], from[4], target[4], query[4], dx, dy, grow, enter, leave, time;
+	int x0, y0, x1, y1, cy, bucket, first, i, end, n, tested, rejected, swept, slot, row;
+
+	archetype = grid->archetype;
+	mask = hitbox(t, sprite, box);
+
+	// Everything the box passed over, widened by how far any row moved to meet it, and by the
+	// pixel the mask test may round to.
+	query[0] = MIN(box[0], box[0] - v->dx) - grid->moveX - 1;
+	query[1] = MIN(box[1], box[1] - v->dy) - grid->moveY - 1;
+	query[2] = MAX(box[2], box[2] - v->dx) + grid->moveX + 1;
+	query[3] = MAX(box[3], box[3] - v->dy) + grid->moveY + 1;
+
+	x0 = cellOf(query[0] - grid->padW, GRID_COLS);
+	y0 = cellOf(query[1] - grid->padH, GRID_ROWS);
+	x1 = cellOf(query[2] + grid->padW, GRID_COLS);
+	y1 = cellOf(query[3] + grid->padH, GRID_ROWS);
+
+	n = 0;
+	tested = 0;
+	rejected = 0;
+	swept = 0;
+
+	for (cy = y0; cy <= y1; cy++)
+	{
+		bucket = (side * GRID_ROWS + cy) * GRID_COLS;
+		first = grid->start[bucket + x0];
+
+		run.minX = grid->boxes.minX + first;
+		run.minY = grid->boxes.minY + first;
+		run.maxX = grid->boxes.maxX + first;
+		run.maxY = grid->boxes.maxY + first;
+		run.count = grid->start[bucket + x1 + 1] - first;
+
+		if (run.count == 0)
+		{
+			continue;
+		}
+
+		tested += run.count;
+
+		// Candidates come back as run indices after the hits so far; the ones the sweep touches
+		// are compacted down over them as archetype rows.
+		for (i = n, end = n + overlapAabbs(&run, query, grid->found + n); i < end; i++)
+		{
+			slot = first + grid->found[i];
+			row = grid->rows[slot];
+
+			dx = v->dx;
+			dy = v->dy;
+
+			// Fighters set their next velocity after moving; the difference over one tick is slight.
+			if (archetype->velocity != NULL)
+			{
+				dx -= archetype->velocity[row].dx;
+				dy -= archetype->velocity[row].dy;
+			}
+
+			// Masks are tested at the nearest whole pixel, up to half a pixel off the path, so
+			// the box that bounds the walk is grown to match.
+			other = (mask != NULL && archetype->sprite != NULL) ? getCollisionMask(archetype->sprite[row]) : NULL;
+			grow = (other != NULL) ? 0.5f : 0;
+
+			from[0] = box[0] - dx - grow;
+			from[1] = box[1] - dy - grow;
+			from[2] = box[2] - dx + grow;
+			from[3] = box[3] - dy + grow;
+
+			target[0] = grid->boxes.minX[slot];
+			target[1] = grid->boxes.minY[slot];
+			target[2] = grid->boxes.maxX[slot];
+			target[3] = grid->boxes.maxY[slot];
+
+			if (!sweepAabb(from, dx, dy, target, &enter, &leave))
+			{
+				continue;
+			}
+
+			time = enter;
+
+			if (other != NULL && !firstTouch(mask, t, dx, dy, other, &archetype->transform[row], enter, leave, &time))
+			{
+				rejected++;
+				continue;
+			}
+
+			// The boxes had parted again by the end of the tick: a test of the end alone misses this.
+			if (leave < 1)
+			{
+				swept++;
+			}
+
+			grid->found[n] = row;
+			grid->times[n] = time;
+			n++;
+		}
+	}
+
+	grid->queries++;
+	grid->candidates += tested;
+
+	METRIC_ADD(METRIC_COLLISION_TESTS, tested);
+	METRIC_ADD(METRIC_COLLISION_HITS, n);
+	METRIC_ADD(METRIC_MASK_REJECTS, rejected);
+	METRIC_ADD(METRIC_SWEPT_HITS, swept);
+
+	return n;
+}
+
+// box is minX, minY, maxX, maxY. Sprites without a mask keep the transform's full size.
+static const CollisionMask *hitbox(const Transform *t, int sprite, float *box)
+{
+	const CollisionMask *mask;
+	int x, y;
+
+	// Where blit() puts the sprite.
+	x = (int)t->x;
+	y = (int)t->y;
+
+	mask = (sprite != 0) ? getCollisionMask(sprite) : NULL;
+
+	if (mask == NULL)
+	{
+		box[0] = x;
+		box[1] = y;
+		box[2] = x + t->w;
+		box[3] = y + t->h;
+	}
+	else
+	{
+		box[0] = x + mask->x;
+		box[1] = y + mask->y;
+		box[2] = box[0] + mask->w;
+		box[3] = box[1] + mask->h;
+	}
+
+	return mask;
+}
+
+// Walks the sprite through [enter, leave] of the tick, moving (dx, dy) a tick relative to o and
+// ending at t, one pixel position at a time: the pixel it is drawn at changes whenever either
+// coordinate crosses a half pixel. Finds the first position where the masks touch.
+static int firstTouch(const CollisionMask *mask, const Transform *t, float dx, float dy, const CollisionMask *other, const Transform *o, float enter, float leave, float *time)
+{
+	float x0, y0, s, next;
+
+	// Rounding to the nearest pixel is flooring half a pixel on; the end lands where blit() draws.
+	x0 = (int)t->x - dx + 0.5f;
+	y0 = (int)t->y - dy + 0.5f;
+
+	for (s = enter; s < leave; s = next)
+	{
+		next = MIN(MIN(nextPixel(x0, dx, s), nextPixel(y0, dy, s)), leave);
+
+		// The position is the same all the way to next; the midpoint keeps clear of the crossings.
+		if (masksOverlap(mask, (int)floorf(x0 + dx * (s + next) / 2), (int)floorf(y0 + dy * (s + next) / 2), other, (int)o->x, (int)o->y))
+		{
+			*time = s;
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+// When after s the coordinate p + d * s next reaches a whole number.
+static float nextPixel(float p, float d, float s)
+{
+	float k, u;
+
+	if (d == 0)
+	{
+		return INFINITY;
+	}
+
+	k = (d > 0) ? floorf(p + d * s) + 1 : ceilf(p + d * s) - 1;
+	u = (k - p) / d;
+
+	// Rounding can land on or before s; the crossing after that one is still ahead.
+	return (u > s) ? u : (k + ((d > 0) ? 1 : -1) - p) / d;
+}
+
+static int cellOf(float v, int cells)
+{
+	int cell;
+
+	cell = (int)floorf(v / GRID_CELL_SIZE);
+
+	return MIN(MAX(cell, 0), cells - 1);
+}
+
+static float *allocColumn(SpatialGrid *grid)
+{
+	float *column;
+
+	column = memAlloc(sizeof(float) * grid->archetype->capacity, MEM_TAG_POOLS);
+
+	if (column == NULL)
+	{
+		LOG_ERROR(LOG_CAT_COLLISION, "Couldn't allocate grid '%s'.", grid->name);
+		exit(1);
+	}
+
+	return column;
+}
@@ -0,0 +1,10 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+void initCollision(int argc, char *argv[]);
+void initGrid(SpatialGrid *grid, const char *name, const Archetype *archetype);
+void destroyGrid(SpatialGrid *grid);
+void buildGrid(SpatialGrid *grid);
+int overlapGrid(SpatialGrid *grid, int side, const Transform *t, int sprite);
+int sweepGrid(SpatialGrid *grid, int side, const Transform *t, int sprite, const Velocity *v);
@@ -7,7 +7,10 @@ Copyright (C) 2023-2025 Asephri.net. All rights reserved.
 #include "highscores.h"
 #include "stage.h"
 #include "text.h"
+#include "texture.h"
+#include "timer.h"
 #include "hud.h"
+#include "render.h"
 #include "title.h"
 
 extern App app;
@@ -20,10 +23,11 @@ static void drawHighscores(void);
 static void doNameInput(void);
 static void drawNameInput(void);
 static void saveHighscores(const char* filename);
+static void timeoutHighscores(EntityId id);
+static void requestHighscoresTextures(void);
 
 static Highscore* newHighscore;
 static int cursorBlink;
-static int timeout;
 
 void loadHighscores(const char* filename, Highscores* highscores)
 {
@@ -42,7 +46,7 @@ void loadHighscores(const char* filename, Highscores* highscores)
 
     fclose(file);
 
-    printf("Highscores loaded from file: %s\n", filename);
+    LOG_INFO(LOG_CAT_APP, "Highscores loaded from file: %s", filename);
 }
 
 static void saveHighscores(const char* filename)
@@ -61,7 +65,7 @@ static void saveHighscores(const char* filename)
 
     fclose(file);
 
-    printf("Highscores saved to file: %s\n", filename);
+    LOG_INFO(LOG_CAT_APP, "Highscores saved to file: %s", filename);
 }
 
 void initHighscoreTable(void)
@@ -82,11 +86,49 @@ void initHighscoreTable(void)
 
 void initHighscores(void)
 {
+    int previous;
+
+    previous = app.scene;
+
     app.delegate.logic = logic;
     app.delegate.draw = draw;
+    app.scene = SCENE_HIGHSCORES;
     memset(app.keyboard, 0, sizeof(int) * MAX_KEYBOARD_KEYS);
 
+    clearTimers();
+
+    requestHighscoresTextures();
+
+    // Prefetched from the title screen or when the player died; whatever is still decoding is waited for here.
+    finishTextures(SCENE_HIGHSCORES);
+
+    // Nothing of the stage is needed here.
+    if (previous != app.scene)
+    {
+        releaseTextures(previous);
+    }
+
+    // The title is next on timeout; its textures decode while the table is up.
+    prefetchTitle();
+
     loadHighscores("highscores.txt", &highscores);
+
+    // With a name to enter, the timeout starts once it has been entered.
+    if (newHighscore == NULL)
+    {
+        scheduleTimer(HIGHSCORES_TIMEOUT, timeoutHighscores, ENTITY_NONE);
+    }
+}
+
+// Starts decoding the score screens in the background so initHighscores() finds them ready.
+void prefetchHighscores(void)
+{
+    requestHighscoresTextures();
+}
+
+static void requestHighscoresTextures(void)
+{
+    requestHud(SCENE_HIGHSCORES);
 }
 
 static void logic(void)
@@ -103,11 +145,6 @@ static void logic(void)
     }
     else
     {
-        if(--timeout <= -500)
-        {
-            timeout = 0;
-            initTitle();
-        }
         if (app.keyboard[SDL_SCANCODE_LCTRL])
         {
             initStage();
@@ -153,6 +190,8 @@ static void doNameInput(void)
         saveHighscores("highscores.txt");
 
         newHighscore = NULL;
+
+        scheduleTimer(HIGHSCORES_TIMEOUT, timeoutHighscores, ENTITY_NONE);
     }
     
 }
@@ -198,8 +237,8 @@ static void drawNameInput(void)
         r.w = GLYPH_WIDTH;
         r.h = GLYPH_HEIGHT;
 
-        SDL_SetRenderDrawColor(app.renderer, 0, 255, 201, 14);
-        SDL_RenderFillRect(app.renderer, &r);
+        setDrawColor(0, 255, 201, 14);
+        renderFillRect(&r);
     }
 
     drawText(355, 448, 255, 255, 255, "HIT ENTER WHEN DONE.");
@@ -239,7 +278,7 @@ void addHighscore(int score)
     Highscore newHighscores[NUM_HIGHSCORES + 1];
     int i;
 
-    memset(newHighscores, 0, sizeof(Highscore) * (NUM_HIGHSCORES + 1));
+    memset(newHighscores, 0, sizeof(newHighscores));
 
     for (i = 0 ; i < NUM_HIGHSCORES ; i++)
     {
@@ -265,7 +304,7 @@ void addHighscore(int score)
     }
 
     // Console message
-    printf("Highscore added.\n");
+    LOG_INFO(LOG_CAT_APP, "Highscore added.");
 }
 
 static int highscoreComparator(const void *a, const void *b)
@@ -274,3 +313,8 @@ static int highscoreComparator(const void *a, const void *b)
     Highscore *h2 = ((Highscore*)b);
     return h2->score - h1->score;
 }
+
+static void timeoutHighscores(EntityId id)
+{
+    initTitle();
+}
@@ -4,4 +4,5 @@ Copyright (C) 2023-2025 Asephri.net. All rights reserved.
 
 void initHighscoreTable(void);
 void initHighscores(void);
+void prefetchHighscores(void);
 void addHighscore(int score);
\ No newline at end of file
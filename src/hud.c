@@ -5,82 +5,61 @@ Copyright (C) 2023-2025 Asephri.net. All rights reserved.
 #include "common.h"
 #include "hud.h"
 #include "draw.h"
+#include "texture.h"
+#include "render.h"
 
 extern App app;
 extern Stage stage;
 
 static int hudX;
 static int hudeffectsX;
-static SDL_Texture *hud;
-static SDL_Texture *hudeffects;
-bool isLoaded = false;
-bool isLoaded2 = false;
-bool isLoaded3 = false;
+static int hud;
+static int hudeffects;
+static int hudFrame;
+static int scoreFrame;
+static int newScoreFrame;
 
 void initHud(void)
 {
     hudX = 0;
     hudeffectsX = 0;
-    hudeffects = loadTexture("gfx/hudeffects.png");
-    if (hudeffects == NULL)
+    hudeffects = requestTexture("gfx/hudeffects.png", TEXTURE_SHARED);
+    if (hudeffects == 0)
     {
         SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to load HUD effects texture: %s\n", SDL_GetError());
         return;
     }
-    printf("HUD initialized.\n");
+    LOG_INFO(LOG_CAT_RENDER, "HUD initialized.");
 }
 
-void doHud(void)
+// The HUD frames are full-screen images, so each scene queues the ones it draws under its own
+// owner with the rest of its textures. Picking a frame during the scene is then just a handle.
+void requestHud(int scene)
 {
-    if (!isLoaded)
+    if (scene == SCENE_HIGHSCORES)
     {
-        hud = loadTexture("gfx/hud.png");
-        if (hud == NULL)
-        {
-            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to load HUD texture: %s\n", SDL_GetError());
-            return;
-        }
-        isLoaded = true;
-        isLoaded2 = false;
-        isLoaded3 = false;
-
-        printf("Main HUD loaded.\n");
+        scoreFrame = requestTexture("gfx/highscorescreen.png", scene);
+        newScoreFrame = requestTexture("gfx/newhighscorescreen.png", scene);
+    }
+    else
+    {
+        hudFrame = requestTexture("gfx/hud.png", scene);
     }
 }
 
-void doHudscore(void)
+void doHud(void)
 {
-    if (!isLoaded2)
-    {
-        hud = loadTexture("gfx/highscorescreen.png");
-        if (hud == NULL)
-        {
-            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to load high score screen texture: %s\n", SDL_GetError());
-            return;
-        }
-        isLoaded2 = true;
-        isLoaded3 = false;
-        isLoaded = false;
+    hud = hudFrame;
+}
 
-        printf("High score screen loaded.\n");
-    }
+void doHudscore(void)
+{
+    hud = scoreFrame;
 }
 
 void doHudInputscore(void)
 {
-    if (!isLoaded3)
-    {
-        hud = loadTexture("gfx/newhighscorescreen.png");
-        if (hud == NULL)
-        {
-            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to load new high score screen texture: %s\n", SDL_GetError());
-            return;
-        }
-        isLoaded3 = true;
-        isLoaded2 = false;
-        isLoaded = false;
-        printf("New high score screen loaded.\n");
-    }
+    hud = newScoreFrame;
 }
 
 void drawHud(void)
@@ -91,7 +70,7 @@ void drawHud(void)
     dest.w = SCREEN_WIDTH;
     dest.h = SCREEN_HEIGHT;
 
-    SDL_RenderCopy(app.renderer, hud, NULL, &dest);
+    renderCopy(getTexture(hud), NULL, &dest);
 }
 
 void drawHudEffects(void)
@@ -102,5 +81,5 @@ void drawHudEffects(void)
     dest.w = SCREEN_WIDTH;
     dest.h = 128;
 
-    SDL_RenderCopy(app.renderer, hudeffects, NULL, &dest);
+    renderCopy(getTexture(hudeffects), NULL, &dest);
 }
\ No newline at end of file
@@ -3,6 +3,7 @@ Copyright (C) 2023-2025 Asephri.net. All rights reserved.
 */
 
 void initHud(void);
+void requestHud(int scene);
 void doHud(void);
 void doHudscore(void);
 void doHudInputscore(void);
@@ -10,80 +10,163 @@ Copyright (C) 2023-2025 Asephri.net. All rights reserved.
 #include "background.h"
 #include "highscores.h"
 #include "init.h"
+#include "loader.h"
 #include "sound.h"
+#include "stage.h"
 #include "text.h"
+#include "texture.h"
 #include "hud.h"
+#include "arena.h"
+#include "memtrack.h"
+#include "packformat.h"
+#include "pack.h"
+#include "metrics.h"
+#include "profile.h"
+#include "sampler.h"
+#include "startup.h"
+#include "timer.h"
+#include "title.h"
 
 extern App app;
 
+static void *decodeIcon(const char *filename);
 
 void initSDL(void)
 {
-    int rendererFlags, windowFlags;
+    SDL_Surface *icon;
+    int rendererFlags, windowFlags, iconJob;
 
-    rendererFlags = SDL_RENDERER_ACCELERATED;
+    rendererFlags = app.benchmark ? SDL_RENDERER_SOFTWARE : SDL_RENDERER_ACCELERATED;
     windowFlags = 0;
 
+    // The icon decodes on a loader thread while the audio device and window open.
+    iconJob = queueLoad(decodeIcon, "icon.ico");
+
+    startupBegin("SDL_Init");
     if (SDL_Init(SDL_INIT_VIDEO) < 0)
     {
-        printf("Couldn't initialize SDL: %s\n", SDL_GetError());
+        LOG_ERROR(LOG_CAT_APP, "Couldn't initialize SDL: %s", SDL_GetError());
         exit(1);
     }
+    startupEnd();
 
-    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 1024) == -1)
+    startupBegin("Mix_OpenAudio");
+    if (Mix_OpenAudio(AUDIO_FREQUENCY, MIX_DEFAULT_FORMAT, AUDIO_CHANNELS, AUDIO_CHUNK_SIZE) == -1)
     {
-        printf("Couldn't initalize SDL Audio Mixer: %s\n", SDL_GetError());
+        LOG_ERROR(LOG_CAT_APP, "Couldn't initalize SDL Audio Mixer: %s", SDL_GetError());
         exit(1);
     }
 
     Mix_AllocateChannels(MAX_SND_CHANNELS);
+    startupEnd();
 
+    startupBegin("SDL_CreateWindow");
     app.window = SDL_CreateWindow(PROJECT_NAME, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH, SCREEN_HEIGHT, windowFlags);
-    SDL_Surface* icon = IMG_Load("icon.ico"); SDL_SetWindowIcon(app.window, icon);
+    startupEnd();
+
+    icon = (iconJob != 0) ? waitLoad(iconJob) : decodeIcon("icon.ico");
+    if (icon != NULL)
+    {
+        SDL_SetWindowIcon(app.window, icon);
+        SDL_FreeSurface(icon);
+    }
 
     SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "nearest");
 
+    startupBegin("SDL_CreateRenderer");
     app.renderer = SDL_CreateRenderer(app.window, -1, rendererFlags);
+    if (app.renderer == NULL)
+    {
+        LOG_ERROR(LOG_CAT_APP, "Couldn't create renderer: %s", SDL_GetError());
+        exit(1);
+    }
+    startupEnd();
 
     IMG_Init(IMG_INIT_PNG | IMG_INIT_JPG);
 
     SDL_ShowCursor(0);
 
-    printf("SDL Initialized.\n");
+    LOG_INFO(LOG_CAT_APP, "SDL Initialized.");
 }
 
 void initGame(void)
 {
-    initBackground();
+    // Textures and sound effects are only queued here; they decode while the rest of init runs.
+    STARTUP_CALL(initBackground);
 
     initStars();
 
-    initSounds();
+    STARTUP_CALL(initSounds);
+
+    STARTUP_CALL(initFonts);
 
-    initFonts();
+    STARTUP_CALL(initHud);
 
-    initHud();
+    // A benchmark goes straight to the stage.
+    if (!app.benchmark)
+    {
+        STARTUP_CALL(prefetchTitle);
+    }
 	
-    initHighscoreTable();
+    STARTUP_CALL(initHighscoreTable);
 
+    startupBegin("loadMusic");
     loadMusic("music/voidfighter - Track 01 (deepspace-01).ogg");
+    startupEnd();
 
     playMusic(1);
 
-    printf("Game initialized.\n");
+    startupBegin("finishTextures");
+    finishTextures(TEXTURE_SHARED);
+    startupEnd();
+
+    LOG_INFO(LOG_CAT_APP, "Game initialized.");
 }
 
 void cleanup(void)
 {
+    shutdownSampler();
+
+    shutdownProfiler();
+
+    shutdownMetrics();
+
+    shutdownStage();
+
+    shutdownTimers();
+
+    shutdownFrameArenas();
+
+    freeSounds();
+
+    destroyTextures();
+
+    // Every job has been collected by now; the pack has to outlive the threads reading it.
+    shutdownLoader();
+
+    closePack();
+
     IMG_Quit();
 
     SDL_DestroyRenderer(app.renderer);
 
     SDL_DestroyWindow(app.window);
 
-	fclose(stdout);
-
     SDL_Quit();
 
-    printf("Cleaned up and quit SDL.\n");
+    LOG_INFO(LOG_CAT_APP, "Cleaned up and quit SDL.");
+
+    reportMemory("at exit");
+
+    if (getLogDroppedCount() > 0)
+    {
+        LOG_WARN(LOG_CAT_APP, "%d log messages were dropped this session.", getLogDroppedCount());
+    }
+
+    shutdownLog();
+}
+
+static void *decodeIcon(const char *filename)
+{
+    return IMG_Load(filename);
 }
@@ -12,7 +12,7 @@ static void doKeyUp(SDL_KeyboardEvent *event)
     if (event->repeat == 0 && event->keysym.scancode < MAX_KEYBOARD_KEYS)
     {
         app.keyboard[event->keysym.scancode] = 0;
-        printf("// Console message. Key released: %d\n", event->keysym.scancode);
+        LOG_DEBUG(LOG_CAT_INPUT, "Key released: %d", event->keysym.scancode);
     }
 }
 
@@ -21,7 +21,7 @@ static void doKeyDown(SDL_KeyboardEvent *event)
     if (event->repeat == 0 && event->keysym.scancode < MAX_KEYBOARD_KEYS)
     {
         app.keyboard[event->keysym.scancode] = 1;
-        printf("// Console message. Key pressed: %d\n", event->keysym.scancode);
+        LOG_DEBUG(LOG_CAT_INPUT, "Key pressed: %d", event->keysym.scancode);
     }
 }
 
@@ -29,7 +29,8 @@ void doInput(void)
 {
     SDL_Event event;
 
-    memset(app.inputText, '\0', MAX_LINE_LENGTH);
+    // Only the first byte needs clearing: text events copy in a terminated string.
+    app.inputText[0] = '\0';
 
     while (SDL_PollEvent(&event))
     {
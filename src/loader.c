@@ -0,0 +1,252 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+#include "common.h"
+#include "loader.h"
+#include "metrics.h"
+#include "startup.h"
+
+// Worker pool for decoding assets off the main thread. queueLoad() returns a job handle, a
+// future for the decoded result: poll it with loadDone() and collect it, exactly once, with
+// waitLoad(). A job nobody has picked up yet is run by the waiting thread itself instead of
+// sleeping. Handle 0 means the job wasn't queued (no threads, or every slot busy) and the
+// caller decodes inline. The name must stay valid until the job has been collected.
+
+typedef struct
+{
+	LoadFunc load;
+	const char *name;
+	void *result;
+	int state;
+} LoadJob;
+
+static int runLoads(void *data);
+static void runJob(LoadJob *job, int thread);
+
+static LoadJob jobs[MAX_LOAD_JOBS];
+static int queue[MAX_LOAD_JOBS];
+static int head;
+static int tail;
+static int pending;
+static int running;
+static SDL_mutex *lock;
+static SDL_cond *queued;
+static SDL_cond *finished;
+static SDL_Thread *threads[LOADER_MAX_THREADS];
+static int numThreads;
+
+void initLoader(void)
+{
+	int i, count;
+
+	lock = SDL_CreateMutex();
+	queued = SDL_CreateCond();
+	finished = SDL_CreateCond();
+
+	if (lock == NULL || queued == NULL || finished == NULL)
+	{
+		LOG_WARN(LOG_CAT_APP, "Couldn't create loader locks (%s), assets load on the main thread.", SDL_GetError());
+		return;
+	}
+
+	// The main thread stays free to upload and to steal jobs it ends up waiting for.
+	count = MIN(MAX(SDL_GetCPUCount() - 1, 1), LOADER_MAX_THREADS);
+	running = 1;
+
+	for (i = 0; i < count; i++)
+	{
+		threads[i] = SDL_CreateThread(runLoads, "loader", (void *)(intptr_t)(i + 1));
+		if (threads[i] == NULL)
+		{
+			LOG_WARN(LOG_CAT_APP, "Couldn't start loader thread %d: %s", i + 1, SDL_GetError());
+			break;
+		}
+
+		numThreads++;
+	}
+
+	LOG_INFO(LOG_CAT_APP, "Asset loader: %d worker threads.", numThreads);
+}
+
+void shutdownLoader(void)
+{
+	int i;
+
+	if (lock == NULL)
+	{
+		return;
+	}
+
+	SDL_LockMutex(lock);
+	running = 0;
+	SDL_CondBroadcast(queued);
+	SDL_UnlockMutex(lock);
+
+	for (i = 0; i < numThreads; i++)
+	{
+		SDL_WaitThread(threads[i], NULL);
+	}
+
+	if (pending > 0)
+	{
+		LOG_WARN(LOG_CAT_APP, "%d asset loads were never collected.", pending);
+	}
+
+	SDL_DestroyCond(finished);
+	SDL_DestroyCond(queued);
+	SDL_DestroyMutex(lock);
+
+	lock = NULL;
+	numThreads = 0;
+}
+
+int queueLoad(LoadFunc load, const char *name)
+{
+	int i;
+
+	if (numThreads == 0)
+	{
+		return 0;
+	}
+
+	SDL_LockMutex(lock);
+
+	for (i = 0; i < MAX_LOAD_JOBS; i++)
+	{
+		if (jobs[i].state == LOAD_FREE)
+		{
+			break;
+		}
+	}
+
+	// Jobs stolen by waitLoad() leave stale ring entries behind until a worker skips them.
+	if (i == MAX_LOAD_JOBS || tail - head >= MAX_LOAD_JOBS)
+	{
+		SDL_UnlockMutex(lock);
+		LOG_WARN(LOG_CAT_APP, "Loader queue full (%d), loading %s inline.", MAX_LOAD_JOBS, name);
+		return 0;
+	}
+
+	jobs[i].load = load;
+	jobs[i].name = name;
+	jobs[i].result = NULL;
+	jobs[i].state = LOAD_QUEUED;
+
+	queue[tail++ % MAX_LOAD_JOBS] = i;
+	pending++;
+
+	SDL_CondSignal(queued);
+	SDL_UnlockMutex(lock);
+
+	METRIC_SET(METRIC_LOADS_PENDING, pending);
+
+	return i + 1;
+}
+
+int loadDone(int job)
+{
+	int done;
+
+	SDL_LockMutex(lock);
+	done = (jobs[job - 1].state == LOAD_DONE);
+	SDL_UnlockMutex(lock);
+
+	return done;
+}
+
+void *waitLoad(int job)
+{
+	LoadJob *j;
+	void *result;
+
+	j = &jobs[job - 1];
+
+	SDL_LockMutex(lock);
+
+	if (j->state == LOAD_QUEUED)
+	{
+		// Still waiting for a worker: do it here rather than sleep. Workers skip it in the queue.
+		j->state = LOAD_RUNNING;
+		SDL_UnlockMutex(lock);
+
+		runJob(j, 0);
+
+		SDL_LockMutex(lock);
+	}
+
+	while (j->state != LOAD_DONE)
+	{
+		SDL_CondWait(finished, lock);
+	}
+
+	result = j->result;
+	j->result = NULL;
+	j->state = LOAD_FREE;
+	pending--;
+
+	SDL_UnlockMutex(lock);
+
+	METRIC_SET(METRIC_LOADS_PENDING, pending);
+
+	return result;
+}
+
+static int runLoads(void *data)
+{
+	LoadJob *job;
+	int thread;
+
+	thread = (int)(intptr_t)data;
+
+	SDL_LockMutex(lock);
+
+	for (;;)
+	{
+		while (running && head == tail)
+		{
+			SDL_CondWait(queued, lock);
+		}
+
+		if (!running)
+		{
+			break;
+		}
+
+		job = &jobs[queue[head++ % MAX_LOAD_JOBS]];
+
+		if (job->state != LOAD_QUEUED)
+		{
+			continue;
+		}
+
+		job->state = LOAD_RUNNING;
+		SDL_UnlockMutex(lock);
+
+		runJob(job, thread);
+
+		SDL_LockMutex(lock);
+	}
+
+	SDL_UnlockMutex(lock);
+
+	return 0;
+}
+
+static void runJob(LoadJob *job, int thread)
+{
+	Uint64 start;
+	void *result;
+
+	start = SDL_GetPerformanceCounter();
+
+	result = job->load(job->name);
+
+	startupSpan(job->name, thread, start, SDL_GetPerformanceCounter());
+
+	SDL_LockMutex(lock);
+	job->result = result;
+	job->state = LOAD_DONE;
+	SDL_CondBroadcast(finished);
+	SDL_UnlockMutex(lock);
+}
@@ -0,0 +1,9 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+void initLoader(void);
+void shutdownLoader(void);
+int queueLoad(LoadFunc load, const char *name);
+int loadDone(int job);
+void *waitLoad(int job);
@@ -0,0 +1,279 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+#include "common.h"
+#include "log.h"
+
+typedef struct
+{
+	SDL_atomic_t sequence;
+	int level;
+	int category;
+	Uint32 ticks;
+	char text[LOG_MESSAGE_LENGTH];
+} LogSlot;
+
+static int drainLog(void *data);
+static void writeSlot(LogSlot *slot);
+static void rotateLogFile(void);
+static void sdlLogOutput(void *userdata, int category, SDL_LogPriority priority, const char *message);
+
+int logLevels[LOG_CAT_MAX];
+
+static LogSlot ring[LOG_RING_SIZE];
+static SDL_atomic_t writePos;
+static int readPos;
+static SDL_atomic_t dropped;
+static SDL_atomic_t running;
+static SDL_Thread *drainThread;
+static FILE *logFile;
+static long logFileSize;
+static int droppedReported;
+
+static const char *levelNames[] = {"TRACE", "DEBUG", "INFO ", "WARN ", "ERROR"};
+static const char *categoryNames[LOG_CAT_MAX] = {"app", "stage", "collision", "input", "sound", "render", "sdl"};
+
+void initLog(void)
+{
+	int i;
+
+	for (i = 0; i < LOG_CAT_MAX; i++)
+	{
+		logLevels[i] = LOG_COMPILE_LEVEL;
+	}
+
+	for (i = 0; i < LOG_RING_SIZE; i++)
+	{
+		SDL_AtomicSet(&ring[i].sequence, i);
+	}
+
+	SDL_AtomicSet(&writePos, 0);
+	SDL_AtomicSet(&dropped, 0);
+	readPos = 0;
+	droppedReported = 0;
+
+	logFile = fopen(LOG_FILENAME, "w");
+	logFileSize = 0;
+
+	SDL_AtomicSet(&running, 1);
+
+	drainThread = SDL_CreateThread(drainLog, "log", NULL);
+	if (drainThread == NULL)
+	{
+		SDL_AtomicSet(&running, 0);
+		fprintf(stderr, "Couldn't start log thread: %s\n", SDL_GetError());
+	}
+
+	SDL_LogSetOutputFunction(sdlLogOutput, NULL);
+}
+
+void shutdownLog(void)
+{
+	if (drainThread != NULL)
+	{
+		SDL_AtomicSet(&running, 0);
+		SDL_WaitThread(drainThread, NULL);
+		drainThread = NULL;
+	}
+
+	if (logFile != NULL)
+	{
+		fclose(logFile);
+		logFile = NULL;
+	}
+}
+
+void setLogLevel(int category, int level)
+{
+	if (category >= 0 && category < LOG_CAT_MAX)
+	{
+		logLevels[category] = level;
+	}
+}
+
+int getLogDroppedCount(void)
+{
+	return SDL_AtomicGet(&dropped);
+}
+
+void logMessage(int level, int category, const char *format, ...)
+{
+	LogSlot *slot;
+	va_list args;
+	int pos, diff;
+
+	if (!SDL_AtomicGet(&running))
+	{
+		// No drain thread (not started yet, or already shut down), so write straight through.
+		va_start(args, format);
+		vfprintf(stderr, format, args);
+		va_end(args);
+		fputc('\n', stderr);
+		return;
+	}
+
+	// Multi-producer claim: a slot is free when its sequence equals the write position.
+	pos = SDL_AtomicGet(&writePos);
+
+	for (;;)
+	{
+		slot = &ring[pos & (LOG_RING_SIZE - 1)];
+		diff = (int)((unsigned)SDL_AtomicGet(&slot->sequence) - (unsigned)pos);
+
+		if (diff == 0)
+		{
+			if (SDL_AtomicCAS(&writePos, pos, pos + 1))
+			{
+				break;
+			}
+		}
+		else if (diff < 0)
+		{
+			// Ring is full; never stall the game loop waiting for the writer.
+			SDL_AtomicAdd(&dropped, 1);
+			return;
+		}
+
+		pos = SDL_AtomicGet(&writePos);
+	}
+
+	slot->level = level;
+	slot->category = category;
+	slot->ticks = SDL_GetTicks();
+
+	va_start(args, format);
+	vsnprintf(slot->text, LOG_MESSAGE_LENGTH, format, args);
+	va_end(args);
+
+	SDL_MemoryBarrierRelease();
+	SDL_AtomicSet(&slot->sequence, pos + 1);
+}
+
+static int drainLog(void *data)
+{
+	LogSlot *slot;
+	int stopping, drained, lost;
+
+	SDL_SetThreadPriority(SDL_THREAD_PRIORITY_LOW);
+
+	for (;;)
+	{
+		stopping = !SDL_AtomicGet(&running);
+		drained = 0;
+
+		for (;;)
+		{
+			slot = &ring[readPos & (LOG_RING_SIZE - 1)];
+
+			if (SDL_AtomicGet(&slot->sequence) != readPos + 1)
+			{
+				break;
+			}
+
+			SDL_MemoryBarrierAcquire();
+			writeSlot(slot);
+
+			SDL_AtomicSet(&slot->sequence, readPos + LOG_RING_SIZE);
+			readPos++;
+			drained++;
+		}
+
+		lost = SDL_AtomicGet(&dropped);
+		if (lost != droppedReported && logFile != NULL)
+		{
+			logFileSize += fprintf(logFile, "[log] %d messages dropped (ring full)\n", lost - droppedReported);
+			droppedReported = lost;
+		}
+
+		if (drained > 0 && logFile != NULL)
+		{
+			fflush(logFile);
+		}
+
+		if (stopping)
+		{
+			break;
+		}
+
+		if (drained == 0)
+		{
+			SDL_Delay(LOG_DRAIN_INTERVAL);
+		}
+	}
+
+	return 0;
+}
+
+static void writeSlot(LogSlot *slot)
+{
+	const char *level;
+
+	if (logFile == NULL)
+	{
+		return;
+	}
+
+	level = (slot->level >= 0 && slot->level < LOG_LEVEL_NONE) ? levelNames[slot->level] : "?????";
+
+	logFileSize += fprintf(logFile, "[%8u] [%s] [%s] %s\n", slot->ticks, level, categoryNames[slot->category], slot->text);
+
+	if (logFileSize >= LOG_MAX_FILE_SIZE)
+	{
+		rotateLogFile();
+	}
+}
+
+static void rotateLogFile(void)
+{
+	char from[MAX_LINE_LENGTH], to[MAX_LINE_LENGTH];
+	int i;
+
+	fclose(logFile);
+
+	// consolelog.txt -> consolelog.txt.1 -> ... -> consolelog.txt.N, oldest discarded.
+	for (i = LOG_MAX_FILES - 1; i >= 1; i--)
+	{
+		snprintf(to, sizeof(to), "%s.%d", LOG_FILENAME, i + 1);
+		snprintf(from, sizeof(from), "%s.%d", LOG_FILENAME, i);
+		remove(to);
+		rename(from, to);
+	}
+
+	snprintf(to, sizeof(to), "%s.1", LOG_FILENAME);
+	remove(to);
+	rename(LOG_FILENAME, to);
+
+	logFile = fopen(LOG_FILENAME, "w");
+	logFileSize = 0;
+}
+
+static void sdlLogOutput(void *userdata, int category, SDL_LogPriority priority, const char *message)
+{
+	int level;
+
+	switch (priority)
+	{
+		case SDL_LOG_PRIORITY_VERBOSE:
+			level = LOG_LEVEL_TRACE;
+			break;
+
+		case SDL_LOG_PRIORITY_DEBUG:
+			level = LOG_LEVEL_DEBUG;
+			break;
+
+		case SDL_LOG_PRIORITY_INFO:
+			level = LOG_LEVEL_INFO;
+			break;
+
+		case SDL_LOG_PRIORITY_WARN:
+			level = LOG_LEVEL_WARN;
+			break;
+
+		default:
+			level = LOG_LEVEL_ERROR;
+			break;
+	}
+
+	LOG_AT(level, LOG_CAT_SDL, "%s", message);
+}
@@ -0,0 +1,48 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+void initLog(void);
+void shutdownLog(void);
+void setLogLevel(int category, int level);
+void logMessage(int level, int category, const char *format, ...);
+int getLogDroppedCount(void);
+
+extern int logLevels[LOG_CAT_MAX];
+
+// Runtime filter, only reached for levels that survived LOG_COMPILE_LEVEL.
+#define LOG_AT(level, category, ...) \
+do { if ((level) >= logLevels[(category)]) logMessage((level), (category), __VA_ARGS__); } while (0)
+
+// Compiled-out levels keep their arguments type-checked but generate no code.
+#define LOG_STRIPPED(category, ...) do { if (0) logMessage(LOG_LEVEL_NONE, (category), __VA_ARGS__); } while (0)
+
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_TRACE
+#define LOG_TRACE(category, ...) LOG_AT(LOG_LEVEL_TRACE, category, __VA_ARGS__)
+#else
+#define LOG_TRACE(category, ...) LOG_STRIPPED(category, __VA_ARGS__)
+#endif
+
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(category, ...) LOG_AT(LOG_LEVEL_DEBUG, category, __VA_ARGS__)
+#else
+#define LOG_DEBUG(category, ...) LOG_STRIPPED(category, __VA_ARGS__)
+#endif
+
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(category, ...) LOG_AT(LOG_LEVEL_INFO, category, __VA_ARGS__)
+#else
+#define LOG_INFO(category, ...) LOG_STRIPPED(category, __VA_ARGS__)
+#endif
+
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN(category, ...) LOG_AT(LOG_LEVEL_WARN, category, __VA_ARGS__)
+#else
+#define LOG_WARN(category, ...) LOG_STRIPPED(category, __VA_ARGS__)
+#endif
+
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(category, ...) LOG_AT(LOG_LEVEL_ERROR, category, __VA_ARGS__)
+#else
+#define LOG_ERROR(category, ...) LOG_STRIPPED(category, __VA_ARGS__)
+#endif
@@ -3,11 +3,28 @@ Copyright (C) 2023-2025 Asephri.net. All rights reserved.
 */
 
 #include "common.h"
+#include "arena.h"
+#include "bench.h"
 #include "draw.h"
+#include "grid.h"
 #include "init.h"
 #include "title.h"
 #include "input.h"
+#include "loader.h"
 #include "main.h"
+#include "memtrack.h"
+#include "metrics.h"
+#include "overlay.h"
+#include "packformat.h"
+#include "pack.h"
+#include "profile.h"
+#include "recorder.h"
+#include "render.h"
+#include "sampler.h"
+#include "startup.h"
+#include "texture.h"
+#include "timer.h"
+#include "util.h"
 
 App app;
 Highscores highscores;
@@ -20,49 +37,149 @@ int main(int argc, char *argv[])
     long then;
     float remainder;
 
-    freopen("consolelog.txt", "w", stdout);
+    initMemTrack();
 
-	printf("----------------------------------------------------------------------------------------------------\n");
+    initStartup();
 
-	printf("voidFighter - New Session\n");
+    initLog();
+
+    initProfiler();
+
+    initFrameArenas();
+
+    initTimers();
+
+	LOG_INFO(LOG_CAT_APP, "----------------------------------------------------------------------------------------------------");
+
+	LOG_INFO(LOG_CAT_APP, "voidFighter - New Session");
 	
-	printf("Copyright (C) 2023-2025 Asephri.net. All rights reserved.\n");
+	LOG_INFO(LOG_CAT_APP, "Copyright (C) 2023-2025 Asephri.net. All rights reserved.");
 
-	printf("consolelog.txt\n");
+	LOG_INFO(LOG_CAT_APP, "consolelog.txt");
 	
-	printf("----------------------------------------------------------------------------------------------------\n");
+	LOG_INFO(LOG_CAT_APP, "----------------------------------------------------------------------------------------------------");
 
     memset(&app, 0, sizeof(App));
 
-    initSDL();
+    app.benchmark = initBenchmark(argc, argv);
+
+    initMetrics(argc, argv);
+
+    initRecorder(argc, argv);
+
+    initSampler(argc, argv);
+
+    initTextures(argc, argv);
+
+    initPack(argc, argv);
+
+    initCollision(argc, argv);
+
+    initLoader();
+
+    STARTUP_CALL(initSDL);
 
     atexit(cleanup);
 
-    initGame();
+    STARTUP_CALL(initGame);
+
+    if (app.benchmark)
+    {
+        runBenchmark();
+
+        return 0;
+    }
 
-    initTitle();
+    STARTUP_CALL(initTitle);
 
     then = SDL_GetTicks();
     remainder = 0;
 
+    startupBegin("firstFrame");
+
     while (1)
     {
-        prepareScene();
+        doFrame();
 
-        doInput();
+        if (app.frame == 1)
+        {
+            startupEnd();
+            finishStartup();
+        }
 
-        app.delegate.logic();
-
-        app.delegate.draw();
-
-        presentScene();
+        SET_PHASE(PHASE_WAIT);
 
+        PROFILE_BEGIN("capFrameRate");
         capFrameRate(&then, &remainder);
+        PROFILE_END();
     }
 
     return 0;
 }
 
+void doFrame(void)
+{
+    Uint64 start, logicStart, drawStart, drawEnd;
+
+    resetFrameArenas();
+
+    PROFILE_BEGIN("frame");
+
+    start = SDL_GetPerformanceCounter();
+
+    beginRenderFrame();
+
+    PROFILE_CALL(pumpTextures);
+
+    SET_PHASE(PHASE_PREPARE);
+    RENDER_PHASE(prepareScene);
+
+    SET_PHASE(PHASE_INPUT);
+    PROFILE_CALL(doInput);
+
+    logicStart = SDL_GetPerformanceCounter();
+
+    SET_PHASE(PHASE_LOGIC);
+    PROFILE_BEGIN("logic");
+    PROFILE_CALL(advanceTimers);
+    app.delegate.logic();
+    PROFILE_END();
+
+    drawStart = SDL_GetPerformanceCounter();
+
+    SET_PHASE(PHASE_DRAW);
+    PROFILE_BEGIN("draw");
+    setRenderPhase("draw");
+    app.delegate.draw();
+    PROFILE_END();
+
+    drawEnd = SDL_GetPerformanceCounter();
+
+    SET_PHASE(PHASE_OVERLAY);
+    RENDER_PHASE(drawOverlay);
+
+    SET_PHASE(PHASE_PRESENT);
+    PROFILE_CALL(presentScene);
+
+    endRenderFrame();
+
+    PROFILE_END();
+
+    app.frameTimes.logic = ticksToMs(drawStart - logicStart);
+    app.frameTimes.draw = ticksToMs(drawEnd - drawStart);
+    app.frameTimes.frame = ticksToMs(SDL_GetPerformanceCounter() - start);
+
+    doOverlay();
+
+    updateMemTrack();
+
+    updateMetrics();
+
+    recordFrame();
+
+    app.frame++;
+}
+
 static void capFrameRate(long *then, float *remainder)
 {
     long wait, frameTime;
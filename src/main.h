@@ -2,4 +2,5 @@
 Copyright (C) 2023-2025 Asephri.net. All rights reserved.
 */
 
-int main(int argc, char *argv[]);
\ No newline at end of file
+int main(int argc, char *argv[]);
+void doFrame(void);
\ No newline at end of file
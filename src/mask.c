@@ -0,0 +1,135 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+#include "common.h"
+#include "mask.h"
+#include "memtrack.h"
+
+// Pixel-accurate narrowphase. A mask is built once per sprite when its texture is uploaded,
+// at the w x h the sprite is drawn at: the tight box around the pixels with at least
+// COLLISION_ALPHA alpha, and each row of that box packed into one 64-bit word. Two sprites
+// placed at whole pixels touch if any row they share ANDs to non-zero after shifting one by
+// the horizontal offset: one shift and one AND per shared row, with no per-pixel work.
+
+CollisionMask *buildCollisionMask(SDL_Surface *surface, int w, int h)
+{
+	CollisionMask *mask;
+	SDL_Surface *argb;
+	Uint64 full[COLLISION_MASK_SIZE], columns;
+	Uint32 *row;
+	int x, y, top, bottom;
+
+	if (w > COLLISION_MASK_SIZE || h > COLLISION_MASK_SIZE)
+	{
+		return NULL;
+	}
+
+	// Paletted and colour-keyed PNGs come out with their transparency as alpha.
+	argb = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+	if (argb == NULL)
+	{
+		return NULL;
+	}
+
+	SDL_LockSurface(argb);
+
+	columns = 0;
+	top = -1;
+	bottom = -1;
+
+	// Sampled the way the renderer scales with nearest filtering.
+	for (y = 0; y < h; y++)
+	{
+		row = (Uint32 *)((Uint8 *)argb->pixels + (y * argb->h / h) * argb->pitch);
+		full[y] = 0;
+
+		for (x = 0; x < w; x++)
+		{
+			if ((row[x * argb->w / w] >> 24) >= COLLISION_ALPHA)
+			{
+				full[y] |= (Uint64)1 << x;
+			}
+		}
+
+		if (full[y] != 0)
+		{
+			top = (top < 0) ? y : top;
+			bottom = y;
+			columns |= full[y];
+		}
+	}
+
+	SDL_UnlockSurface(argb);
+	SDL_FreeSurface(argb);
+
+	mask = memAlloc(sizeof(CollisionMask), MEM_TAG_TEXTURES);
+	if (mask == NULL)
+	{
+		return NULL;
+	}
+
+	memset(mask, 0, sizeof(CollisionMask));
+
+	if (top < 0)
+	{
+		return mask;
+	}
+
+	while ((columns & 1) == 0)
+	{
+		columns >>= 1;
+		mask->x++;
+	}
+
+	while (columns != 0)
+	{
+		columns >>= 1;
+		mask->w++;
+	}
+
+	mask->y = top;
+	mask->h = bottom - top + 1;
+
+	for (y = 0; y < mask->h; y++)
+	{
+		mask->rows[y] = full[top + y] >> mask->x;
+	}
+
+	return mask;
+}
+
+// ax, ay and bx, by are where each sprite's top left corner is drawn.
+int masksOverlap(const CollisionMask *a, int ax, int ay, const CollisionMask *b, int bx, int by)
+{
+	const Uint64 *rowA, *rowB;
+	int dx, top, bottom, y;
+
+	ax += a->x;
+	ay += a->y;
+	bx += b->x;
+	by += b->y;
+
+	dx = bx - ax;
+	top = MAX(ay, by);
+	bottom = MIN(ay + a->h, by + b->h);
+
+	// Shifting a 64-bit word by 64 or more is undefined, and nothing could line up anyway.
+	if (dx >= a->w || -dx >= b->w || top >= bottom)
+	{
+		return 0;
+	}
+
+	rowA = a->rows + (top - ay);
+	rowB = b->rows + (top - by);
+
+	for (y = top; y < bottom; y++, rowA++, rowB++)
+	{
+		if ((dx >= 0 ? (*rowA >> dx) & *rowB : *rowA & (*rowB >> -dx)) != 0)
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
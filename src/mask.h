@@ -0,0 +1,6 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+CollisionMask *buildCollisionMask(SDL_Surface *surface, int w, int h);
+int masksOverlap(const CollisionMask *a, int ax, int ay, const CollisionMask *b, int bx, int by);
@@ -0,0 +1,275 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+#include "common.h"
+#include "memtrack.h"
+#include "metrics.h"
+
+#define MEM_MAGIC 0x564d454dU
+#define MEM_FREED 0x44454144U
+
+// Each thread has its own scope, so loader threads tag their decoding like the main thread does.
+#if defined(_MSC_VER)
+#define MEM_THREAD_LOCAL __declspec(thread)
+#else
+#define MEM_THREAD_LOCAL _Thread_local
+#endif
+
+// Prefixed to every tracked block. Two doubles keep the payload aligned for anything the game stores.
+// magic marks live and freed blocks for a debugger; nothing reads it back.
+typedef union
+{
+	struct
+	{
+		size_t size;
+		unsigned tag;
+		unsigned magic;
+	} info;
+	double align[2];
+} MemHeader;
+
+typedef struct
+{
+	SDL_atomic_t liveBytes;
+	SDL_atomic_t liveBlocks;
+	SDL_atomic_t peakBytes;
+	SDL_atomic_t allocs;
+} MemStats;
+
+static void *trackedMalloc(size_t size);
+static void *trackedCalloc(size_t count, size_t size);
+static void *trackedRealloc(void *ptr, size_t size);
+static void trackedFree(void *ptr);
+static void *allocTagged(size_t size, int tag);
+static void account(int tag, long bytes, int blocks);
+static void raisePeak(SDL_atomic_t *peak, int value);
+static int currentTag(void);
+
+static const char *tagNames[MEM_TAG_MAX] = {"sdl", "textures", "audio", "pools"};
+
+static SDL_malloc_func realMalloc = malloc;
+static SDL_calloc_func realCalloc = calloc;
+static SDL_realloc_func realRealloc = realloc;
+static SDL_free_func realFree = free;
+
+static MemStats stats[MEM_TAG_MAX];
+static SDL_atomic_t totalBytes;
+static SDL_atomic_t totalPeak;
+static SDL_atomic_t totalAllocs;
+static MEM_THREAD_LOCAL int scopeTag = MEM_TAG_SDL;
+static long lastAllocs;
+static long frameAllocs;
+
+void initMemTrack(void)
+{
+	SDL_GetMemoryFunctions(&realMalloc, &realCalloc, &realRealloc, &realFree);
+
+	// The hooks read a header in front of every block they free, so they only go in while SDL
+	// holds no block from the old allocator; after that every block SDL frees is one of ours.
+	if (SDL_GetNumAllocations() > 0)
+	{
+		LOG_WARN(LOG_CAT_APP, "SDL allocated before memory tracking started, only game allocations will be tracked.");
+	}
+	else if (SDL_SetMemoryFunctions(trackedMalloc, trackedCalloc, trackedRealloc, trackedFree) != 0)
+	{
+		LOG_WARN(LOG_CAT_APP, "Couldn't hook SDL's allocator, only game allocations will be tracked.");
+	}
+
+	scopeTag = MEM_TAG_SDL;
+	lastAllocs = 0;
+	frameAllocs = 0;
+}
+
+void *memAlloc(size_t size, int tag)
+{
+	return allocTagged(size, tag);
+}
+
+void memFree(void *ptr)
+{
+	trackedFree(ptr);
+}
+
+int pushMemTag(int tag)
+{
+	int previous;
+
+	previous = scopeTag;
+	scopeTag = tag;
+
+	return previous;
+}
+
+void popMemTag(int previous)
+{
+	scopeTag = previous;
+}
+
+void updateMemTrack(void)
+{
+	long allocs;
+
+	allocs = SDL_AtomicGet(&totalAllocs);
+	frameAllocs = allocs - lastAllocs;
+	lastAllocs = allocs;
+
+	METRIC_SET(METRIC_HEAP_BYTES, SDL_AtomicGet(&totalBytes));
+	METRIC_SET(METRIC_HEAP_PEAK, SDL_AtomicGet(&totalPeak));
+	METRIC_ADD(METRIC_ALLOCS, frameAllocs);
+}
+
+long getMemLiveBytes(int tag)
+{
+	return (tag < 0) ? SDL_AtomicGet(&totalBytes) : SDL_AtomicGet(&stats[tag].liveBytes);
+}
+
+long getMemFrameAllocs(void)
+{
+	return frameAllocs;
+}
+
+void reportMemory(const char *when)
+{
+	MemStats *s;
+	int i;
+
+	LOG_INFO(LOG_CAT_APP, "Memory %s: %d bytes live, peak %d bytes, %d allocations.",
+		when, SDL_AtomicGet(&totalBytes), SDL_AtomicGet(&totalPeak), SDL_AtomicGet(&totalAllocs));
+
+	for (i = 0; i < MEM_TAG_MAX; i++)
+	{
+		s = &stats[i];
+
+		LOG_INFO(LOG_CAT_APP, "  %-10s %9d bytes in %6d blocks, peak %9d bytes, %8d allocations",
+			tagNames[i], SDL_AtomicGet(&s->liveBytes), SDL_AtomicGet(&s->liveBlocks), SDL_AtomicGet(&s->peakBytes), SDL_AtomicGet(&s->allocs));
+	}
+
+	// Only called at cleanup, when everything should be gone.
+	for (i = 0; i < MEM_TAG_MAX; i++)
+	{
+		if (SDL_AtomicGet(&stats[i].liveBlocks) > 0)
+		{
+			LOG_WARN(LOG_CAT_APP, "Leak: %d blocks (%d bytes) tagged '%s' still live %s.",
+				SDL_AtomicGet(&stats[i].liveBlocks), SDL_AtomicGet(&stats[i].liveBytes), tagNames[i], when);
+		}
+	}
+}
+
+static void *trackedMalloc(size_t size)
+{
+	return allocTagged(size, currentTag());
+}
+
+static void *trackedCalloc(size_t count, size_t size)
+{
+	void *ptr;
+
+	if (size != 0 && count > ((size_t)-1 - sizeof(MemHeader)) / size)
+	{
+		return NULL;
+	}
+
+	ptr = allocTagged(count * size, currentTag());
+	if (ptr != NULL)
+	{
+		memset(ptr, 0, count * size);
+	}
+
+	return ptr;
+}
+
+static void *trackedRealloc(void *ptr, size_t size)
+{
+	MemHeader *header, *resized;
+	size_t oldSize;
+
+	if (ptr == NULL)
+	{
+		return trackedMalloc(size);
+	}
+
+	header = (MemHeader *)ptr - 1;
+	oldSize = header->info.size;
+
+	resized = realRealloc(header, sizeof(MemHeader) + size);
+	if (resized == NULL)
+	{
+		return NULL;
+	}
+
+	resized->info.size = size;
+	account(resized->info.tag, (long)size - (long)oldSize, 0);
+
+	return resized + 1;
+}
+
+static void trackedFree(void *ptr)
+{
+	MemHeader *header;
+
+	if (ptr == NULL)
+	{
+		return;
+	}
+
+	header = (MemHeader *)ptr - 1;
+	header->info.magic = MEM_FREED;
+	account(header->info.tag, -(long)header->info.size, -1);
+
+	realFree(header);
+}
+
+static void *allocTagged(size_t size, int tag)
+{
+	MemHeader *header;
+
+	header = realMalloc(sizeof(MemHeader) + size);
+	if (header == NULL)
+	{
+		return NULL;
+	}
+
+	header->info.size = size;
+	header->info.tag = tag;
+	header->info.magic = MEM_MAGIC;
+
+	SDL_AtomicAdd(&stats[tag].allocs, 1);
+	SDL_AtomicAdd(&totalAllocs, 1);
+	account(tag, size, 1);
+
+	return header + 1;
+}
+
+static void account(int tag, long bytes, int blocks)
+{
+	int live, total;
+
+	live = SDL_AtomicAdd(&stats[tag].liveBytes, bytes) + bytes;
+	total = SDL_AtomicAdd(&totalBytes, bytes) + bytes;
+	SDL_AtomicAdd(&stats[tag].liveBlocks, blocks);
+
+	if (bytes > 0)
+	{
+		raisePeak(&stats[tag].peakBytes, live);
+		raisePeak(&totalPeak, total);
+	}
+}
+
+static void raisePeak(SDL_atomic_t *peak, int value)
+{
+	int old;
+
+	old = SDL_AtomicGet(peak);
+
+	while (value > old && !SDL_AtomicCAS(peak, old, value))
+	{
+		old = SDL_AtomicGet(peak);
+	}
+}
+
+static int currentTag(void)
+{
+	// Outside any scope, on any thread (audio and log included), allocations count as SDL.
+	return scopeTag;
+}
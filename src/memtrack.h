@@ -0,0 +1,16 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+void initMemTrack(void);
+void *memAlloc(size_t size, int tag);
+void memFree(void *ptr);
+int pushMemTag(int tag);
+void popMemTag(int previous);
+void updateMemTrack(void);
+long getMemLiveBytes(int tag);
+long getMemFrameAllocs(void);
+void reportMemory(const char *when);
+
+// Attributes SDL's own allocations made during the call (texture surfaces, decoded audio) to a tag.
+#define MEM_SCOPE(tag, call) do { int _previousTag = pushMemTag(tag); call; popMemTag(_previousTag); } while (0)
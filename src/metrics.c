@@ -0,0 +1,341 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+#include "common.h"
+#include "metrics.h"
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// A scraper hanging up early must not SIGPIPE the game.
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SEND_FLAGS 0
+#endif
+#endif
+
+enum
+{
+	METRIC_TYPE_GAUGE,
+	METRIC_TYPE_COUNTER
+};
+
+typedef struct
+{
+	const char *name;
+	const char *label;
+	int type;
+	const char *help;
+} MetricInfo;
+
+static int formatMetrics(char *buffer, int size);
+static void writeMetricsFile(void);
+static void openMetricsSocket(const char *path);
+static void serveMetricsSocket(void);
+
+extern App app;
+
+long metrics[METRIC_MAX];
+
+static const MetricInfo metricInfo[METRIC_MAX] = {
+	{"voidfighter_stage_entities", "list=\"fighter\"", METRIC_TYPE_GAUGE, "Live entities per Stage list."},
+	{"voidfighter_stage_entities", "list=\"bullet\"", METRIC_TYPE_GAUGE, NULL},
+	{"voidfighter_stage_entities", "list=\"explosion\"", METRIC_TYPE_GAUGE, NULL},
+	{"voidfighter_stage_entities", "list=\"debris\"", METRIC_TYPE_GAUGE, NULL},
+	{"voidfighter_stage_entities", "list=\"trail\"", METRIC_TYPE_GAUGE, NULL},
+	{"voidfighter_stage_entities", "list=\"fire\"", METRIC_TYPE_GAUGE, NULL},
+	{"voidfighter_stage_entities", "list=\"points\"", METRIC_TYPE_GAUGE, NULL},
+	{"voidfighter_spawns", NULL, METRIC_TYPE_COUNTER, "Stage objects spawned."},
+	{"voidfighter_frees", NULL, METRIC_TYPE_COUNTER, "Stage objects freed."},
+	{"voidfighter_collision_tests", NULL, METRIC_TYPE_COUNTER, "Pairwise collision tests."},
+	{"voidfighter_sounds", NULL, METRIC_TYPE_COUNTER, "playSound calls."},
+	{"voidfighter_texture_lookups", NULL, METRIC_TYPE_COUNTER, "Texture cache lookups."},
+	{"voidfighter_texture_misses", NULL, METRIC_TYPE_COUNTER, "Texture cache misses (loads from disk)."},
+	{"voidfighter_frames", NULL, METRIC_TYPE_COUNTER, "Frames rendered."},
+	{"voidfighter_frame_time_us", NULL, METRIC_TYPE_GAUGE, "Last frame's work time in microseconds."},
+	{"voidfighter_logic_time_us", NULL, METRIC_TYPE_GAUGE, "Last frame's logic time in microseconds."},
+	{"voidfighter_draw_time_us", NULL, METRIC_TYPE_GAUGE, "Last frame's draw time in microseconds."},
+	{"voidfighter_heap_bytes", NULL, METRIC_TYPE_GAUGE, "Live bytes allocated through the tracked allocators."},
+	{"voidfighter_heap_peak_bytes", NULL, METRIC_TYPE_GAUGE, "High-water mark of voidfighter_heap_bytes."},
+	{"voidfighter_allocations", NULL, METRIC_TYPE_COUNTER, "Tracked heap allocations."},
+	{"voidfighter_draw_calls", NULL, METRIC_TYPE_COUNTER, "Render copies, lines, rects and clears submitted."},
+	{"voidfighter_render_state_changes", NULL, METRIC_TYPE_COUNTER, "Draw colour, blend mode and texture colour/alpha/blend changes."},
+	{"voidfighter_texture_switches", NULL, METRIC_TYPE_COUNTER, "Render copies using a different texture than the previous one."},
+	{"voidfighter_pixels_covered", NULL, METRIC_TYPE_COUNTER, "Destination pixels touched by draw calls, clipped to the screen."},
+	{"voidfighter_pool_exhausted", NULL, METRIC_TYPE_COUNTER, "Spawns dropped because an entity pool was full."},
+	{"voidfighter_frame_arena_bytes", NULL, METRIC_TYPE_GAUGE, "Bytes of per-frame scratch used by the last frame."},
+	{"voidfighter_frame_arena_peak_bytes", NULL, METRIC_TYPE_GAUGE, "High-water mark of voidfighter_frame_arena_bytes."},
+	{"voidfighter_timers", NULL, METRIC_TYPE_GAUGE, "Timers pending in the timing wheel."},
+	{"voidfighter_timers_fired", NULL, METRIC_TYPE_COUNTER, "Timers that expired and ran their callback."},
+	{"voidfighter_texture_bytes", NULL, METRIC_TYPE_GAUGE, "Estimated bytes of resident textures."},
+	{"voidfighter_texture_evictions", NULL, METRIC_TYPE_COUNTER, "Unreferenced textures evicted to stay under the texture budget."},
+	{"voidfighter_loads_pending", NULL, METRIC_TYPE_GAUGE, "Asset loads queued or decoding on the loader threads."},
+	{"voidfighter_collision_hits", NULL, METRIC_TYPE_COUNTER, "Pairwise collision tests that found an overlap."},
+	{"voidfighter_contacts", NULL, METRIC_TYPE_COUNTER, "Collision contacts recorded for resolution."},
+	{"voidfighter_contact_effects", NULL, METRIC_TYPE_COUNTER, "Hit effect bursts emitted after merging contacts."},
+	{"voidfighter_collision_mask_rejects", NULL, METRIC_TYPE_COUNTER, "Hitbox overlaps whose pixel masks did not touch."},
+	{"voidfighter_collision_swept_hits", NULL, METRIC_TYPE_COUNTER, "Bullet hits found only by sweeping: the boxes had parted again by the end of the tick."}
+};
+
+static long previous[METRIC_MAX];
+static long frameDelta[METRIC_MAX];
+static const char *metricsFilename;
+static int metricsInterval;
+static char metricsBuffer[METRICS_BUFFER_SIZE];
+
+#ifndef _WIN32
+static int listenSocket = -1;
+static const char *socketPath;
+#endif
+
+void initMetrics(int argc, char *argv[])
+{
+	const char *path;
+	int i;
+
+	memset(metrics, 0, sizeof(metrics));
+	memset(previous, 0, sizeof(previous));
+	memset(frameDelta, 0, sizeof(frameDelta));
+
+	path = NULL;
+	metricsFilename = NULL;
+	metricsInterval = METRICS_INTERVAL;
+
+	for (i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--metrics-socket") == 0)
+		{
+			path = (i + 1 < argc && argv[i + 1][0] != '-') ? argv[++i] : METRICS_SOCKET;
+		}
+		else if (strcmp(argv[i], "--metrics-file") == 0 && i + 1 < argc)
+		{
+			metricsFilename = argv[++i];
+		}
+		else if (strcmp(argv[i], "--metrics-interval") == 0 && i + 1 < argc)
+		{
+			metricsInterval = atoi(argv[++i]);
+			metricsInterval = MAX(1, metricsInterval);
+		}
+	}
+
+	if (path != NULL)
+	{
+		openMetricsSocket(path);
+	}
+
+	if (metricsFilename != NULL)
+	{
+		LOG_INFO(LOG_CAT_APP, "Metrics will be written to %s every %d frames.", metricsFilename, metricsInterval);
+	}
+}
+
+void updateMetrics(void)
+{
+	int i;
+
+	METRIC_ADD(METRIC_FRAMES, 1);
+	METRIC_SET(METRIC_FRAME_TIME, app.frameTimes.frame * 1000);
+	METRIC_SET(METRIC_LOGIC_TIME, app.frameTimes.logic * 1000);
+	METRIC_SET(METRIC_DRAW_TIME, app.frameTimes.draw * 1000);
+
+	for (i = 0; i < METRIC_MAX; i++)
+	{
+		frameDelta[i] = metrics[i] - previous[i];
+		previous[i] = metrics[i];
+	}
+
+	if (metricsFilename != NULL && metrics[METRIC_FRAMES] % metricsInterval == 0)
+	{
+		writeMetricsFile();
+	}
+
+	serveMetricsSocket();
+}
+
+long getMetricFrameDelta(int metric)
+{
+	return frameDelta[metric];
+}
+
+void shutdownMetrics(void)
+{
+	if (metricsFilename != NULL)
+	{
+		writeMetricsFile();
+	}
+
+#ifndef _WIN32
+	if (listenSocket >= 0)
+	{
+		close(listenSocket);
+		unlink(socketPath);
+		listenSocket = -1;
+	}
+#endif
+}
+
+static int formatMetrics(char *buffer, int size)
+{
+	const MetricInfo *info;
+	int i, len;
+
+	len = 0;
+
+	for (i = 0; i < METRIC_MAX && len < size; i++)
+	{
+		info = &metricInfo[i];
+
+		if (info->type == METRIC_TYPE_COUNTER)
+		{
+			len += snprintf(buffer + len, size - len,
+				"# HELP %s_total %s\n# TYPE %s_total counter\n%s_total %ld\n"
+				"# HELP %s_last_frame %s (last frame)\n# TYPE %s_last_frame gauge\n%s_last_frame %ld\n",
+				info->name, info->help, info->name, info->name, metrics[i],
+				info->name, info->help, info->name, info->name, frameDelta[i]);
+
+			continue;
+		}
+
+		if (info->help != NULL)
+		{
+			len += snprintf(buffer + len, size - len, "# HELP %s %s\n# TYPE %s gauge\n", info->name, info->help, info->name);
+		}
+
+		if (len >= size)
+		{
+			break;
+		}
+
+		if (info->label != NULL)
+		{
+			len += snprintf(buffer + len, size - len, "%s{%s} %ld\n", info->name, info->label, metrics[i]);
+		}
+		else
+		{
+			len += snprintf(buffer + len, size - len, "%s %ld\n", info->name, metrics[i]);
+		}
+	}
+
+	return MIN(len, size - 1);
+}
+
+static void writeMetricsFile(void)
+{
+	char tmpFilename[MAX_LINE_LENGTH];
+	FILE *file;
+	int len;
+
+	len = formatMetrics(metricsBuffer, sizeof(metricsBuffer));
+
+	// Write then rename, so a scraper tailing the file never sees half a dump.
+	snprintf(tmpFilename, sizeof(tmpFilename), "%s.tmp", metricsFilename);
+
+	file = fopen(tmpFilename, "w");
+	if (file == NULL)
+	{
+		LOG_ERROR(LOG_CAT_APP, "Couldn't write metrics file %s.", tmpFilename);
+		return;
+	}
+
+	fwrite(metricsBuffer, 1, len, file);
+	fclose(file);
+
+	remove(metricsFilename);
+	rename(tmpFilename, metricsFilename);
+}
+
+#ifndef _WIN32
+
+static void openMetricsSocket(const char *path)
+{
+	struct sockaddr_un addr;
+
+	if (strlen(path) >= sizeof(addr.sun_path))
+	{
+		LOG_ERROR(LOG_CAT_APP, "Metrics socket path too long: %s", path);
+		return;
+	}
+
+	listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listenSocket < 0)
+	{
+		LOG_ERROR(LOG_CAT_APP, "Couldn't create metrics socket: %s", strerror(errno));
+		return;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, path);
+
+	unlink(path);
+
+	if (bind(listenSocket, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(listenSocket, 4) < 0)
+	{
+		LOG_ERROR(LOG_CAT_APP, "Couldn't listen on metrics socket %s: %s", path, strerror(errno));
+		close(listenSocket);
+		listenSocket = -1;
+		return;
+	}
+
+	// The game loop polls once per frame and must never block on a scraper.
+	fcntl(listenSocket, F_SETFL, fcntl(listenSocket, F_GETFL, 0) | O_NONBLOCK);
+
+	socketPath = path;
+
+	LOG_INFO(LOG_CAT_APP, "Serving Prometheus metrics on unix socket %s.", path);
+}
+
+static void serveMetricsSocket(void)
+{
+	char header[128], request[512];
+	int client, len, headerLen;
+
+	if (listenSocket < 0)
+	{
+		return;
+	}
+
+	client = accept(listenSocket, NULL, NULL);
+	if (client < 0)
+	{
+		return;
+	}
+
+	fcntl(client, F_SETFL, fcntl(client, F_GETFL, 0) | O_NONBLOCK);
+
+	// Whatever request has arrived is discarded; every connection gets the full exposition.
+	while (read(client, request, sizeof(request)) > 0)
+	{
+	}
+
+	len = formatMetrics(metricsBuffer, sizeof(metricsBuffer));
+
+	headerLen = snprintf(header, sizeof(header),
+		"HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %d\r\n\r\n", len);
+
+	if (send(client, header, headerLen, SEND_FLAGS) < 0 || send(client, metricsBuffer, len, SEND_FLAGS) < 0)
+	{
+		LOG_DEBUG(LOG_CAT_APP, "Metrics scrape aborted: %s", strerror(errno));
+	}
+
+	close(client);
+}
+
+#else
+
+static void openMetricsSocket(const char *path)
+{
+	LOG_WARN(LOG_CAT_APP, "Metrics socket is not supported on this platform, use --metrics-file.");
+}
+
+static void serveMetricsSocket(void)
+{
+}
+
+#endif
@@ -0,0 +1,14 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+void initMetrics(int argc, char *argv[]);
+void updateMetrics(void);
+void shutdownMetrics(void);
+long getMetricFrameDelta(int metric);
+
+// Main thread only; a plain array bump so it is safe to leave in hot loops.
+extern long metrics[METRIC_MAX];
+
+#define METRIC_ADD(metric, n) (metrics[(metric)] += (n))
+#define METRIC_SET(metric, n) (metrics[(metric)] = (n))
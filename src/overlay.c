@@ -0,0 +1,175 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+#include "common.h"
+#include "memtrack.h"
+#include "metrics.h"
+#include "overlay.h"
+#include "render.h"
+#include "text.h"
+#include "util.h"
+
+extern App app;
+
+typedef struct
+{
+	float logic;
+	float draw;
+	float frame;
+	float interval;
+} OverlaySample;
+
+static void drawGraph(int x, int y);
+static float averageInterval(void);
+
+static OverlaySample history[OVERLAY_HISTORY];
+static int historyPos;
+static int visible;
+static int keyWasDown;
+static Uint64 lastFrameStart;
+
+void doOverlay(void)
+{
+	OverlaySample *sample;
+	Uint64 now;
+
+	if (app.keyboard[OVERLAY_KEY] && !keyWasDown)
+	{
+		visible = !visible;
+	}
+
+	keyWasDown = app.keyboard[OVERLAY_KEY];
+
+	// Always record, so the graph is already full the moment the overlay is switched on.
+	now = SDL_GetPerformanceCounter();
+
+	sample = &history[historyPos];
+	sample->logic = app.frameTimes.logic;
+	sample->draw = app.frameTimes.draw;
+	sample->frame = app.frameTimes.frame;
+	sample->interval = (lastFrameStart != 0) ? ticksToMs(now - lastFrameStart) : 0;
+
+	historyPos = (historyPos + 1) % OVERLAY_HISTORY;
+	lastFrameStart = now;
+}
+
+void drawOverlay(void)
+{
+	OverlaySample *last;
+	SDL_Rect panel;
+	float interval;
+	int x, y;
+
+	if (!visible)
+	{
+		return;
+	}
+
+	x = OVERLAY_X;
+	y = OVERLAY_Y;
+
+	panel.x = x - 4;
+	panel.y = y - 4;
+	panel.w = MAX(OVERLAY_HISTORY, 26 * GLYPH_WIDTH) + 8;
+	panel.h = OVERLAY_GRAPH_HEIGHT + 9 * GLYPH_HEIGHT + 12;
+
+	setDrawBlendMode(SDL_BLENDMODE_BLEND);
+	setDrawColor(0, 0, 0, 192);
+	renderFillRect(&panel);
+
+	drawGraph(x, y);
+
+	setDrawBlendMode(SDL_BLENDMODE_NONE);
+
+	last = &history[(historyPos + OVERLAY_HISTORY - 1) % OVERLAY_HISTORY];
+	interval = averageInterval();
+
+	y += OVERLAY_GRAPH_HEIGHT + 4;
+
+	drawText(x, y, 255, 255, 255, "FPS %5.1f / %d", (interval > 0) ? 1000.0 / interval : 0.0, FPS);
+	y += GLYPH_HEIGHT;
+
+	drawText(x, y, 255, 255, 255, "FRAME %6.2f MS", last->frame);
+	y += GLYPH_HEIGHT;
+
+	drawText(x, y, 0, 255, 0, "LOGIC %6.2f", last->logic);
+	drawText(x + 13 * GLYPH_WIDTH, y, 64, 160, 255, "DRAW %6.2f", last->draw);
+	y += GLYPH_HEIGHT;
+
+	drawText(x, y, 255, 255, 255, "FTR %-4ld BLT %-4ld PTS %ld", metrics[METRIC_FIGHTERS], metrics[METRIC_BULLETS], metrics[METRIC_POINTS]);
+	y += GLYPH_HEIGHT;
+
+	drawText(x, y, 255, 255, 255, "EXP %-5ld DEB %ld", metrics[METRIC_EXPLOSIONS], metrics[METRIC_DEBRIS]);
+	y += GLYPH_HEIGHT;
+
+	drawText(x, y, 255, 255, 255, "TRL %-5ld FIR %ld", metrics[METRIC_TRAILS], metrics[METRIC_FIRE]);
+	y += GLYPH_HEIGHT;
+
+	drawText(x, y, 255, 201, 14, "ALLOC +%-4ld FREE -%ld", getMetricFrameDelta(METRIC_SPAWNS), getMetricFrameDelta(METRIC_FREES));
+	y += GLYPH_HEIGHT;
+
+	drawText(x, y, 255, 255, 255, "DC %-5ld ST %-5ld TX %-4ld PX %ldK", getMetricFrameDelta(METRIC_DRAW_CALLS), getMetricFrameDelta(METRIC_STATE_CHANGES),
+		getMetricFrameDelta(METRIC_TEXTURE_SWITCHES), getMetricFrameDelta(METRIC_PIXELS) / 1000);
+	y += GLYPH_HEIGHT;
+
+	drawText(x, y, 255, 201, 14, "HEAP %ldK PEAK %ldK %ld/F", metrics[METRIC_HEAP_BYTES] / 1024, metrics[METRIC_HEAP_PEAK] / 1024, getMemFrameAllocs());
+}
+
+static void drawGraph(int x, int y)
+{
+	OverlaySample *sample;
+	int i, bottom, logic, draw, frame, target;
+
+	bottom = y + OVERLAY_GRAPH_HEIGHT;
+
+	// One column per frame, oldest on the left: logic stacked under draw, the rest of the frame's work above.
+	for (i = 0; i < OVERLAY_HISTORY; i++)
+	{
+		sample = &history[(historyPos + i) % OVERLAY_HISTORY];
+
+		logic = MIN(OVERLAY_GRAPH_HEIGHT, (int)(sample->logic * OVERLAY_GRAPH_SCALE));
+		draw = MIN(OVERLAY_GRAPH_HEIGHT - logic, (int)(sample->draw * OVERLAY_GRAPH_SCALE));
+		frame = MIN(OVERLAY_GRAPH_HEIGHT, (int)(sample->frame * OVERLAY_GRAPH_SCALE));
+
+		if (frame > 0)
+		{
+			setDrawColor(128, 128, 128, 255);
+			renderDrawLine(x + i, bottom, x + i, bottom - frame);
+		}
+
+		if (draw > 0)
+		{
+			setDrawColor(64, 160, 255, 255);
+			renderDrawLine(x + i, bottom - logic, x + i, bottom - logic - draw);
+		}
+
+		if (logic > 0)
+		{
+			setDrawColor(0, 255, 0, 255);
+			renderDrawLine(x + i, bottom, x + i, bottom - logic);
+		}
+	}
+
+	target = MIN(OVERLAY_GRAPH_HEIGHT, OVERLAY_GRAPH_SCALE * 1000 / FPS);
+
+	setDrawColor(255, 0, 0, 255);
+	renderDrawLine(x, bottom - target, x + OVERLAY_HISTORY, bottom - target);
+}
+
+static float averageInterval(void)
+{
+	float sum;
+	int i, n;
+
+	sum = 0;
+	n = 0;
+
+	for (i = 1; i <= FPS; i++)
+	{
+		sum += history[(historyPos + OVERLAY_HISTORY - i) % OVERLAY_HISTORY].interval;
+		n++;
+	}
+
+	return sum / n;
+}
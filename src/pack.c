@@ -0,0 +1,281 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "common.h"
+#include "packformat.h"
+#include "pack.h"
+#include "util.h"
+
+// The pack is mapped read-only for the whole session. Textures and sound chunks are made
+// straight from the mapped bytes, so nothing is decoded, resampled or copied into the heap;
+// the OS pages the data in as it is first touched.
+
+static int mapPack(const char *filename);
+static void unmapPack(void);
+static int validatePack(const char *filename);
+static int validateEntry(const PackEntry *entry);
+static int compareEntry(const void *key, const void *entry);
+
+static const Uint8 *base;
+static size_t mappedSize;
+static const PackEntry *entries;
+static int count;
+static SDL_atomic_t served;
+static SDL_atomic_t missed;
+
+void initPack(int argc, char *argv[])
+{
+	const char *filename;
+	Uint64 start;
+	int i;
+
+	filename = PACK_FILENAME;
+
+	for (i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--pack") == 0 && i + 1 < argc)
+		{
+			filename = argv[++i];
+		}
+		else if (strcmp(argv[i], "--no-pack") == 0)
+		{
+			filename = NULL;
+		}
+	}
+
+	if (filename == NULL)
+	{
+		LOG_INFO(LOG_CAT_APP, "Asset pack disabled, loading loose files.");
+		return;
+	}
+
+	start = SDL_GetPerformanceCounter();
+
+	if (!mapPack(filename))
+	{
+		LOG_INFO(LOG_CAT_APP, "No asset pack at %s, loading loose files.", filename);
+		return;
+	}
+
+	if (!validatePack(filename))
+	{
+		unmapPack();
+		return;
+	}
+
+	LOG_INFO(LOG_CAT_APP, "Asset pack %s mapped: %d assets, %ld KB, in %.2f ms.", filename, count, (long)(mappedSize / 1024), ticksToMs(SDL_GetPerformanceCounter() - start));
+}
+
+void closePack(void)
+{
+	if (base == NULL)
+	{
+		return;
+	}
+
+	LOG_INFO(LOG_CAT_APP, "Asset pack: %d assets served from the pack, %d loaded from loose files.", SDL_AtomicGet(&served), SDL_AtomicGet(&missed));
+
+	unmapPack();
+}
+
+const PackEntry *findPackEntry(const char *name, int type)
+{
+	const PackEntry *entry;
+
+	if (base == NULL)
+	{
+		return NULL;
+	}
+
+	entry = bsearch(name, entries, count, sizeof(PackEntry), compareEntry);
+
+	if (entry == NULL || entry->type != (uint32_t)type)
+	{
+		LOG_WARN(LOG_CAT_APP, "'%s' is not in the asset pack; rebake it.", name);
+		SDL_AtomicAdd(&missed, 1);
+		return NULL;
+	}
+
+	// Lookups come from the loader threads too.
+	SDL_AtomicAdd(&served, 1);
+
+	return entry;
+}
+
+const void *packData(const PackEntry *entry)
+{
+	return base + entry->offset;
+}
+
+static int mapPack(const char *filename)
+{
+#ifdef _WIN32
+	HANDLE file, mapping;
+	LARGE_INTEGER size;
+	void *view;
+
+	file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return 0;
+	}
+
+	if (!GetFileSizeEx(file, &size) || size.QuadPart < (LONGLONG)sizeof(PackHeader))
+	{
+		CloseHandle(file);
+		return 0;
+	}
+
+	mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+	if (mapping == NULL)
+	{
+		return 0;
+	}
+
+	// The view keeps the mapping alive on its own.
+	view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (view == NULL)
+	{
+		return 0;
+	}
+
+	base = view;
+	mappedSize = (size_t)size.QuadPart;
+#else
+	struct stat st;
+	void *view;
+	int fd;
+
+	fd = open(filename, O_RDONLY);
+	if (fd < 0)
+	{
+		return 0;
+	}
+
+	if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(PackHeader))
+	{
+		close(fd);
+		return 0;
+	}
+
+	view = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (view == MAP_FAILED)
+	{
+		return 0;
+	}
+
+	base = view;
+	mappedSize = st.st_size;
+#endif
+
+	return 1;
+}
+
+static void unmapPack(void)
+{
+#ifdef _WIN32
+	UnmapViewOfFile(base);
+#else
+	munmap((void *)base, mappedSize);
+#endif
+
+	base = NULL;
+	mappedSize = 0;
+	entries = NULL;
+	count = 0;
+}
+
+static int validatePack(const char *filename)
+{
+	const PackHeader *header;
+	int i;
+
+	header = (const PackHeader *)base;
+
+	if (memcmp(header->magic, PACK_MAGIC, 4) != 0 || header->version != PACK_VERSION || header->entrySize != sizeof(PackEntry))
+	{
+		LOG_WARN(LOG_CAT_APP, "%s is not a version %d asset pack; ignoring it.", filename, PACK_VERSION);
+		return 0;
+	}
+
+	if (header->size != mappedSize || header->count > (mappedSize - sizeof(PackHeader)) / sizeof(PackEntry))
+	{
+		LOG_WARN(LOG_CAT_APP, "%s is truncated; ignoring it.", filename);
+		return 0;
+	}
+
+	entries = (const PackEntry *)(header + 1);
+	count = header->count;
+
+	// Checked once here so every later lookup can trust the offsets and the layout of the data.
+	for (i = 0; i < count; i++)
+	{
+		if (entries[i].offset > mappedSize || entries[i].size > mappedSize - entries[i].offset || entries[i].name[PACK_NAME_LENGTH - 1] != '\0')
+		{
+			LOG_WARN(LOG_CAT_APP, "%s: entry %d is out of bounds; ignoring the pack.", filename, i);
+			return 0;
+		}
+
+		if (!validateEntry(&entries[i]))
+		{
+			LOG_WARN(LOG_CAT_APP, "%s: entry %d (%s) doesn't fit its own data; ignoring the pack.", filename, i, entries[i].name);
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+// Images are wrapped in a surface and sounds in a chunk exactly as described, so the
+// description has to stay inside the entry's bytes.
+static int validateEntry(const PackEntry *entry)
+{
+	Uint64 row, frame;
+
+	switch (entry->type)
+	{
+		case PACK_IMAGE:
+			if (SDL_ISPIXELFORMAT_FOURCC(entry->format) || SDL_BYTESPERPIXEL(entry->format) == 0)
+			{
+				return 0;
+			}
+
+			// SDL takes the sizes as ints.
+			if (entry->w == 0 || entry->h == 0 || entry->w > SDL_MAX_SINT32 || entry->h > SDL_MAX_SINT32 || entry->pitch > SDL_MAX_SINT32)
+			{
+				return 0;
+			}
+
+			row = (Uint64)entry->w * SDL_BYTESPERPIXEL(entry->format);
+
+			return entry->pitch >= row && (Uint64)entry->pitch * entry->h <= entry->size;
+
+		case PACK_SOUND:
+			frame = (Uint64)entry->channels * (SDL_AUDIO_BITSIZE(entry->format) / 8);
+
+			// Mix_QuickLoad_RAW takes a 32-bit length, and a partial sample frame would be read past.
+			return frame > 0 && entry->size <= SDL_MAX_UINT32 && entry->size % frame == 0;
+
+		default:
+			return 0;
+	}
+}
+
+static int compareEntry(const void *key, const void *entry)
+{
+	return strncmp(key, ((const PackEntry *)entry)->name, PACK_NAME_LENGTH);
+}
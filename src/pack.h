@@ -0,0 +1,8 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+void initPack(int argc, char *argv[]);
+void closePack(void);
+const PackEntry *findPackEntry(const char *name, int type);
+const void *packData(const PackEntry *entry);
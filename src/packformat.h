@@ -0,0 +1,43 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+// On-disk layout of baked asset packs, shared with tools/packbake.c. Fixed-width types only, no SDL.
+// The index follows the header, sorted by name; every entry's data starts on a PACK_ALIGN boundary.
+
+#include <stdint.h>
+
+#define PACK_MAGIC "VFP1"
+#define PACK_VERSION 1
+#define PACK_NAME_LENGTH 64
+#define PACK_ALIGN 64
+
+enum
+{
+	PACK_IMAGE,
+	PACK_SOUND
+};
+
+typedef struct
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t entrySize;
+	uint32_t count;
+	uint64_t size;
+} PackHeader;
+
+typedef struct
+{
+	char name[PACK_NAME_LENGTH];
+	uint32_t type;
+	uint32_t format;
+	uint32_t w;
+	uint32_t h;
+	uint32_t pitch;
+	uint32_t frequency;
+	uint32_t channels;
+	uint32_t reserved;
+	uint64_t offset;
+	uint64_t size;
+} PackEntry;
@@ -0,0 +1,202 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+#include "common.h"
+#include "draw.h"
+#include "memtrack.h"
+#include "metrics.h"
+#include "particle.h"
+#include "render.h"
+#include "texture.h"
+
+static void *allocField(ParticleSystem *system, size_t size);
+static void moveParticle(ParticleSystem *system, int to, int from);
+
+void initParticles(ParticleSystem *system, const char *name, int capacity, int flags, float ax, float ay, int metric)
+{
+	memset(system, 0, sizeof(ParticleSystem));
+
+	system->name = name;
+	system->capacity = capacity;
+	system->flags = flags;
+	system->ax = ax;
+	system->ay = ay;
+	system->metric = metric;
+
+	system->x = allocField(system, sizeof(float));
+	system->y = allocField(system, sizeof(float));
+	system->dx = allocField(system, sizeof(float));
+	system->dy = allocField(system, sizeof(float));
+	system->life = allocField(system, sizeof(int));
+	system->color = allocField(system, sizeof(Uint32));
+	system->src = allocField(system, sizeof(SDL_Rect));
+	system->texture = allocField(system, sizeof(int));
+
+	LOG_INFO(LOG_CAT_STAGE, "Particle system '%s': %d particles.", name, capacity);
+}
+
+void destroyParticles(ParticleSystem *system)
+{
+	if (system->x != NULL)
+	{
+		LOG_INFO(LOG_CAT_STAGE, "Particle system '%s': %ld particles dropped at capacity.", system->name, system->dropped);
+	}
+
+	memFree(system->x);
+	memFree(system->y);
+	memFree(system->dx);
+	memFree(system->dy);
+	memFree(system->life);
+	memFree(system->color);
+	memFree(system->src);
+	memFree(system->texture);
+
+	memset(system, 0, sizeof(ParticleSystem));
+}
+
+int emitParticles(ParticleSystem *system, int n, int *first)
+{
+	int emitted;
+
+	// A burst is one range reservation; the caller fills fields [first, first + emitted).
+	emitted = MIN(n, system->capacity - system->count);
+
+	if (emitted < n)
+	{
+		system->dropped += n - emitted;
+		METRIC_ADD(METRIC_POOL_EXHAUSTED, n - emitted);
+	}
+
+	*first = system->count;
+	system->count += emitted;
+
+	METRIC_ADD(system->metric, emitted);
+	METRIC_ADD(METRIC_SPAWNS, emitted);
+
+	return emitted;
+}
+
+void updateParticles(ParticleSystem *system)
+{
+	float *restrict x, *restrict y, *restrict dx, *restrict dy;
+	int *restrict life;
+	float ax, ay;
+	int i, n, before;
+
+	x = system->x;
+	y = system->y;
+	dx = system->dx;
+	dy = system->dy;
+	life = system->life;
+	ax = system->ax;
+	ay = system->ay;
+	n = system->count;
+
+	// Branch-free over plain arrays so the compiler can vectorise it.
+	for (i = 0; i < n; i++)
+	{
+		x[i] += dx[i];
+		y[i] += dy[i];
+		dx[i] += ax;
+		dy[i] += ay;
+		life[i]--;
+	}
+
+	// Swap-remove: the last live particle fills each hole, so the arrays stay dense.
+	before = n;
+	i = 0;
+
+	while (i < n)
+	{
+		if (life[i] <= 0)
+		{
+			moveParticle(system, i, --n);
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	system->count = n;
+
+	METRIC_ADD(system->metric, n - before);
+	METRIC_ADD(METRIC_FREES, before - n);
+}
+
+void drawParticles(ParticleSystem *system)
+{
+	SDL_Texture *texture, *last;
+	Uint32 c;
+	int i;
+
+	if (system->flags & PARTICLE_GLOW)
+	{
+		setDrawBlendMode(SDL_BLENDMODE_ADD);
+
+		last = NULL;
+
+		for (i = 0; i < system->count; i++)
+		{
+			c = system->color[i];
+
+			texture = getTexture(system->texture[i]);
+
+			if (texture != last)
+			{
+				setTextureBlend(texture, SDL_BLENDMODE_ADD);
+				last = texture;
+			}
+
+			setTextureColor(texture, (c >> 16) & 0xff, (c >> 8) & 0xff, c & 0xff);
+			setTextureAlpha(texture, MIN(system->life[i], 255));
+
+			blit(texture, system->x[i], system->y[i]);
+		}
+
+		setDrawBlendMode(SDL_BLENDMODE_NONE);
+	}
+	else
+	{
+		for (i = 0; i < system->count; i++)
+		{
+			blitRect(getTexture(system->texture[i]), &system->src[i], system->x[i], system->y[i]);
+		}
+	}
+}
+
+void clearParticles(ParticleSystem *system)
+{
+	METRIC_ADD(METRIC_FREES, system->count);
+	METRIC_SET(system->metric, 0);
+
+	system->count = 0;
+}
+
+static void *allocField(ParticleSystem *system, size_t size)
+{
+	void *field;
+
+	field = memAlloc(size * system->capacity, MEM_TAG_POOLS);
+
+	if (field == NULL)
+	{
+		LOG_ERROR(LOG_CAT_STAGE, "Couldn't allocate particle system '%s'.", system->name);
+		exit(1);
+	}
+
+	return field;
+}
+
+static void moveParticle(ParticleSystem *system, int to, int from)
+{
+	system->x[to] = system->x[from];
+	system->y[to] = system->y[from];
+	system->dx[to] = system->dx[from];
+	system->dy[to] = system->dy[from];
+	system->life[to] = system->life[from];
+	system->color[to] = system->color[from];
+	system->src[to] = system->src[from];
+	system->texture[to] = system->texture[from];
+}
@@ -0,0 +1,12 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+void initParticles(ParticleSystem *system, const char *name, int capacity, int flags, float ax, float ay, int metric);
+void destroyParticles(ParticleSystem *system);
+int emitParticles(ParticleSystem *system, int n, int *first);
+void updateParticles(ParticleSystem *system);
+void drawParticles(ParticleSystem *system);
+void clearParticles(ParticleSystem *system);
+
+#define PARTICLE_RGB(r, g, b) (((Uint32)(r) << 16) | ((Uint32)(g) << 8) | (Uint32)(b))
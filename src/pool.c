@@ -0,0 +1,91 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+#include "common.h"
+#include "memtrack.h"
+#include "metrics.h"
+#include "pool.h"
+#include "util.h"
+
+// Fixed-size blocks carved from one slab. Freed blocks go on an intrusive free list; untouched
+// blocks are handed out by bumping an index, which is what makes poolReset O(1).
+
+void initPool(Pool *pool, const char *name, int size, int capacity)
+{
+	memset(pool, 0, sizeof(Pool));
+
+	pool->name = name;
+	pool->size = MAX(size, (int)sizeof(void *));
+	pool->capacity = capacity;
+	pool->slab = memAlloc((size_t)pool->size * capacity, MEM_TAG_POOLS);
+
+	if (pool->slab == NULL)
+	{
+		LOG_ERROR(LOG_CAT_STAGE, "Couldn't allocate %s pool (%d x %d bytes).", name, capacity, pool->size);
+		exit(1);
+	}
+
+	LOG_INFO(LOG_CAT_STAGE, "Pool '%s': %d x %d bytes.", name, capacity, pool->size);
+}
+
+void destroyPool(Pool *pool)
+{
+	if (pool->slab != NULL)
+	{
+		LOG_INFO(LOG_CAT_STAGE, "Pool '%s': peak %d of %d, exhausted %ld times.", pool->name, pool->peak, pool->capacity, pool->exhausted);
+	}
+
+	memFree(pool->slab);
+	memset(pool, 0, sizeof(Pool));
+}
+
+void *poolAlloc(Pool *pool)
+{
+	void *ptr;
+
+	if (pool->freeList != NULL)
+	{
+		ptr = pool->freeList;
+		pool->freeList = *(void **)ptr;
+	}
+	else if (pool->next < pool->capacity)
+	{
+		ptr = pool->slab + (size_t)pool->next * pool->size;
+		pool->next++;
+	}
+	else
+	{
+		// Callers drop the spawn.
+		pool->exhausted++;
+		METRIC_ADD(METRIC_POOL_EXHAUSTED, 1);
+
+		if (shouldWarn(pool->exhausted))
+		{
+			LOG_WARN(LOG_CAT_STAGE, "Pool '%s' exhausted (%d live), %ld spawns dropped so far.", pool->name, pool->capacity, pool->exhausted);
+		}
+
+		return NULL;
+	}
+
+	pool->used++;
+	pool->peak = MAX(pool->peak, pool->used);
+
+	memset(ptr, 0, pool->size);
+
+	return ptr;
+}
+
+void poolFree(Pool *pool, void *ptr)
+{
+	*(void **)ptr = pool->freeList;
+	pool->freeList = ptr;
+	pool->used--;
+}
+
+void poolReset(Pool *pool)
+{
+	pool->freeList = NULL;
+	pool->next = 0;
+	pool->used = 0;
+}
@@ -0,0 +1,9 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+void initPool(Pool *pool, const char *name, int size, int capacity);
+void destroyPool(Pool *pool);
+void *poolAlloc(Pool *pool);
+void poolFree(Pool *pool, void *ptr);
+void poolReset(Pool *pool);
@@ -0,0 +1,131 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+#include "common.h"
+#include "profile.h"
+
+typedef struct
+{
+	const char *name;
+	Uint64 start;
+	Uint64 end;
+} ProfileEvent;
+
+typedef struct
+{
+	const char *name;
+	Uint64 start;
+} ProfileZone;
+
+static ProfileEvent *events;
+static long eventCount;
+static ProfileZone stack[PROFILE_MAX_DEPTH];
+static int depth;
+static int overflow;
+static Uint64 origin;
+
+void initProfiler(void)
+{
+#ifdef ENABLE_PROFILER
+	events = malloc(sizeof(ProfileEvent) * PROFILE_MAX_EVENTS);
+	if (events == NULL)
+	{
+		LOG_ERROR(LOG_CAT_APP, "Couldn't allocate profiler event buffer.");
+		return;
+	}
+
+	eventCount = 0;
+	depth = 0;
+	overflow = 0;
+	origin = SDL_GetPerformanceCounter();
+
+	LOG_INFO(LOG_CAT_APP, "Profiler enabled, trace will be written to %s.", PROFILE_FILENAME);
+#endif
+}
+
+void profileBegin(const char *name)
+{
+	if (depth >= PROFILE_MAX_DEPTH)
+	{
+		overflow++;
+		return;
+	}
+
+	stack[depth].name = name;
+	stack[depth].start = SDL_GetPerformanceCounter();
+	depth++;
+}
+
+void profileEnd(void)
+{
+	ProfileEvent *event;
+	Uint64 now;
+
+	now = SDL_GetPerformanceCounter();
+
+	if (overflow > 0)
+	{
+		overflow--;
+		return;
+	}
+
+	if (depth == 0 || events == NULL)
+	{
+		return;
+	}
+
+	depth--;
+
+	// Oldest events are overwritten so the trace always ends at the moment of exit.
+	event = &events[eventCount % PROFILE_MAX_EVENTS];
+	event->name = stack[depth].name;
+	event->start = stack[depth].start;
+	event->end = now;
+	eventCount++;
+}
+
+void shutdownProfiler(void)
+{
+	FILE *file;
+	ProfileEvent *event;
+	double frequency;
+	long i, first;
+
+	if (events == NULL)
+	{
+		return;
+	}
+
+	file = fopen(PROFILE_FILENAME, "w");
+	if (file == NULL)
+	{
+		LOG_ERROR(LOG_CAT_APP, "Couldn't write profiler trace %s.", PROFILE_FILENAME);
+		free(events);
+		events = NULL;
+		return;
+	}
+
+	// Chrome/Perfetto timestamps are in microseconds.
+	frequency = SDL_GetPerformanceFrequency() / 1000000.0;
+	first = MAX(0, eventCount - PROFILE_MAX_EVENTS);
+
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"main\"}}");
+
+	for (i = first; i < eventCount; i++)
+	{
+		event = &events[i % PROFILE_MAX_EVENTS];
+
+		fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+			event->name, (event->start - origin) / frequency, (event->end - event->start) / frequency);
+	}
+
+	fprintf(file, "\n]}\n");
+	fclose(file);
+
+	LOG_INFO(LOG_CAT_APP, "Profiler trace written to %s (%ld zones, %ld overwritten).", PROFILE_FILENAME, eventCount - first, first);
+
+	free(events);
+	events = NULL;
+}
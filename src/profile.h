@@ -0,0 +1,19 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+void initProfiler(void);
+void shutdownProfiler(void);
+void profileBegin(const char *name);
+void profileEnd(void);
+
+// Zones are main-thread only and must nest. Built only with -DENABLE_PROFILER (VOIDFIGHTER_PROFILE in CMake).
+#ifdef ENABLE_PROFILER
+#define PROFILE_BEGIN(name) profileBegin(name)
+#define PROFILE_END() profileEnd()
+#else
+#define PROFILE_BEGIN(name) do { } while (0)
+#define PROFILE_END() do { } while (0)
+#endif
+
+#define PROFILE_CALL(function) do { PROFILE_BEGIN(#function); function(); PROFILE_END(); } while (0)
@@ -0,0 +1,144 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+#include "common.h"
+#include "metrics.h"
+#include "recordformat.h"
+#include "recorder.h"
+#include "util.h"
+
+extern App app;
+
+static void dumpRecords(void);
+
+static FlightRecord records[RECORDER_FRAMES];
+static long recordCount;
+static int enabled;
+static float budget;
+static long cooldown;
+static int dumps;
+static Uint64 lastFrameStart;
+
+void initRecorder(int argc, char *argv[])
+{
+	int i;
+
+	// Benchmark runs are unthrottled software-rendered frames; they would trip the budget constantly.
+	enabled = !app.benchmark;
+	budget = RECORDER_BUDGET_MS;
+
+	for (i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--no-recorder") == 0)
+		{
+			enabled = 0;
+		}
+		else if (strcmp(argv[i], "--hitch-budget") == 0 && i + 1 < argc)
+		{
+			budget = atof(argv[++i]);
+		}
+	}
+
+	recordCount = 0;
+	cooldown = 0;
+	dumps = 0;
+	lastFrameStart = 0;
+
+	if (enabled)
+	{
+		LOG_INFO(LOG_CAT_APP, "Flight recorder armed, budget %.1f ms, keeping %d frames.", budget, RECORDER_FRAMES);
+	}
+}
+
+void recordFrame(void)
+{
+	FlightRecord *record;
+	Uint64 now;
+	int i;
+
+	if (!enabled)
+	{
+		return;
+	}
+
+	now = SDL_GetPerformanceCounter();
+
+	// Steady state is one struct fill per frame, no allocation and no I/O.
+	record = &records[recordCount % RECORDER_FRAMES];
+	record->frame = app.frame;
+	record->scene = app.scene;
+	record->frameMs = app.frameTimes.frame;
+	record->logicMs = app.frameTimes.logic;
+	record->drawMs = app.frameTimes.draw;
+	record->intervalMs = (lastFrameStart != 0) ? ticksToMs(now - lastFrameStart) : 0;
+
+	for (i = 0; i < RECORD_LISTS; i++)
+	{
+		record->entities[i] = metrics[METRIC_FIGHTERS + i];
+	}
+
+	record->spawns = getMetricFrameDelta(METRIC_SPAWNS);
+	record->frees = getMetricFrameDelta(METRIC_FREES);
+	record->sounds = getMetricFrameDelta(METRIC_SOUNDS);
+	record->collisionTests = getMetricFrameDelta(METRIC_COLLISION_TESTS);
+	record->textureMisses = getMetricFrameDelta(METRIC_TEXTURE_MISSES);
+
+	recordCount++;
+	lastFrameStart = now;
+
+	if (cooldown > 0)
+	{
+		cooldown--;
+	}
+	else if (record->frameMs > budget && dumps < RECORDER_MAX_DUMPS)
+	{
+		dumpRecords();
+
+		// Let the ring refill so consecutive dumps don't overlap.
+		cooldown = RECORDER_FRAMES;
+	}
+}
+
+static void dumpRecords(void)
+{
+	char filename[MAX_LINE_LENGTH];
+	FlightHeader header;
+	FILE *file;
+	long i, first;
+
+	snprintf(filename, sizeof(filename), "hitch_%06ld.vfr", app.frame);
+
+	file = fopen(filename, "wb");
+	if (file == NULL)
+	{
+		LOG_ERROR(LOG_CAT_APP, "Couldn't write hitch recording %s.", filename);
+		return;
+	}
+
+	first = MAX(0, recordCount - RECORDER_FRAMES);
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, RECORD_MAGIC, 4);
+	header.version = RECORD_VERSION;
+	header.recordSize = sizeof(FlightRecord);
+	header.count = recordCount - first;
+	header.triggerFrame = app.frame;
+	header.fps = FPS;
+	header.budgetMs = budget;
+
+	fwrite(&header, sizeof(header), 1, file);
+
+	// Oldest first.
+	for (i = first; i < recordCount; i++)
+	{
+		fwrite(&records[i % RECORDER_FRAMES], sizeof(FlightRecord), 1, file);
+	}
+
+	fclose(file);
+
+	dumps++;
+
+	LOG_WARN(LOG_CAT_APP, "Frame %ld took %.2f ms (budget %.1f ms), last %u frames written to %s.",
+		app.frame, app.frameTimes.frame, budget, header.count, filename);
+}
@@ -0,0 +1,38 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+// On-disk layout of hitch recordings, shared with tools/vfrdecode.c. Fixed-width types only, no SDL.
+
+#include <stdint.h>
+
+#define RECORD_MAGIC "VFR1"
+#define RECORD_VERSION 1
+#define RECORD_LISTS 7
+
+typedef struct
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t recordSize;
+	uint32_t count;
+	uint32_t triggerFrame;
+	uint32_t fps;
+	float budgetMs;
+} FlightHeader;
+
+typedef struct
+{
+	uint32_t frame;
+	uint32_t scene;
+	float frameMs;
+	float logicMs;
+	float drawMs;
+	float intervalMs;
+	uint32_t entities[RECORD_LISTS];
+	uint32_t spawns;
+	uint32_t frees;
+	uint32_t sounds;
+	uint32_t collisionTests;
+	uint32_t textureMisses;
+} FlightRecord;
@@ -0,0 +1,313 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+#include "common.h"
+#include "metrics.h"
+#include "render.h"
+
+extern App app;
+
+typedef struct
+{
+	const char *name;
+	RenderStats frame;
+	RenderStats total;
+} RenderPhase;
+
+static RenderStats *phaseStats(void);
+static void addStats(RenderStats *to, RenderStats *from);
+static long coveredPixels(const SDL_Rect *rect);
+static void writeStats(FILE *file, const char *name, RenderStats *stats, long frames, int last);
+
+static RenderPhase phases[RENDER_MAX_PHASES];
+static int phaseCount;
+static RenderPhase *current;
+static RenderStats frameStats;
+static long totalFrames;
+
+// Last state handed to SDL, to tell texture switches and redundant state sets apart.
+static SDL_Texture *lastTexture;
+static Uint32 lastDrawColor;
+static int lastDrawBlend;
+static SDL_Texture *lastColorTexture;
+static Uint32 lastTextureColor;
+static SDL_Texture *lastAlphaTexture;
+static int lastTextureAlpha;
+
+void beginRenderFrame(void)
+{
+	int i;
+
+	for (i = 0; i < phaseCount; i++)
+	{
+		memset(&phases[i].frame, 0, sizeof(RenderStats));
+	}
+
+	setRenderPhase("other");
+
+	lastTexture = NULL;
+	lastDrawColor = 0;
+	lastDrawBlend = -1;
+	lastColorTexture = NULL;
+	lastAlphaTexture = NULL;
+}
+
+void endRenderFrame(void)
+{
+	int i;
+
+	memset(&frameStats, 0, sizeof(RenderStats));
+
+	for (i = 0; i < phaseCount; i++)
+	{
+		addStats(&frameStats, &phases[i].frame);
+		addStats(&phases[i].total, &phases[i].frame);
+	}
+
+	totalFrames++;
+
+	METRIC_ADD(METRIC_DRAW_CALLS, frameStats.drawCalls);
+	METRIC_ADD(METRIC_STATE_CHANGES, frameStats.stateChanges);
+	METRIC_ADD(METRIC_TEXTURE_SWITCHES, frameStats.textureSwitches);
+	METRIC_ADD(METRIC_PIXELS, frameStats.pixels);
+}
+
+const char *setRenderPhase(const char *name)
+{
+	const char *previous;
+	int i;
+
+	previous = (current != NULL) ? current->name : "other";
+
+	// Phase names are string literals, so the pointer compare almost always hits first.
+	for (i = 0; i < phaseCount; i++)
+	{
+		if (phases[i].name == name || strcmp(phases[i].name, name) == 0)
+		{
+			current = &phases[i];
+			return previous;
+		}
+	}
+
+	if (phaseCount < RENDER_MAX_PHASES)
+	{
+		current = &phases[phaseCount++];
+		memset(current, 0, sizeof(RenderPhase));
+		current->name = name;
+	}
+	else
+	{
+		current = &phases[0];
+	}
+
+	return previous;
+}
+
+void resetRenderTotals(void)
+{
+	int i;
+
+	for (i = 0; i < phaseCount; i++)
+	{
+		memset(&phases[i].total, 0, sizeof(RenderStats));
+	}
+
+	totalFrames = 0;
+}
+
+void getRenderFrameStats(RenderStats *stats)
+{
+	*stats = frameStats;
+}
+
+void writeRenderReport(FILE *file)
+{
+	RenderStats all;
+	int i;
+
+	memset(&all, 0, sizeof(RenderStats));
+
+	for (i = 0; i < phaseCount; i++)
+	{
+		addStats(&all, &phases[i].total);
+	}
+
+	// Per-frame means, overall and per draw phase.
+	fprintf(file, "  \"render\": {\n");
+	writeStats(file, "frame", &all, totalFrames, 0);
+	fprintf(file, "    \"phases\": {\n");
+
+	for (i = 0; i < phaseCount; i++)
+	{
+		fprintf(file, "  ");
+		writeStats(file, phases[i].name, &phases[i].total, totalFrames, i == phaseCount - 1);
+	}
+
+	fprintf(file, "    }\n  },\n");
+}
+
+void renderClear(void)
+{
+	RenderStats *stats = phaseStats();
+
+	stats->drawCalls++;
+	stats->pixels += SCREEN_WIDTH * (SCREEN_HEIGHT);
+
+	SDL_RenderClear(app.renderer);
+}
+
+void renderCopy(SDL_Texture *texture, const SDL_Rect *src, const SDL_Rect *dest)
+{
+	RenderStats *stats = phaseStats();
+
+	stats->drawCalls++;
+	stats->pixels += coveredPixels(dest);
+
+	if (texture != lastTexture)
+	{
+		stats->textureSwitches++;
+		lastTexture = texture;
+	}
+
+	SDL_RenderCopy(app.renderer, texture, src, dest);
+}
+
+void renderDrawLine(int x1, int y1, int x2, int y2)
+{
+	RenderStats *stats = phaseStats();
+
+	stats->drawCalls++;
+	stats->pixels += MAX(abs(x2 - x1), abs(y2 - y1)) + 1;
+
+	SDL_RenderDrawLine(app.renderer, x1, y1, x2, y2);
+}
+
+void renderFillRect(const SDL_Rect *rect)
+{
+	RenderStats *stats = phaseStats();
+
+	stats->drawCalls++;
+	stats->pixels += coveredPixels(rect);
+
+	SDL_RenderFillRect(app.renderer, rect);
+}
+
+void setDrawColor(int r, int g, int b, int a)
+{
+	RenderStats *stats = phaseStats();
+	Uint32 color;
+
+	color = ((Uint32)r << 24) | ((Uint32)g << 16) | ((Uint32)b << 8) | (Uint32)a;
+
+	stats->stateChanges++;
+	if (color == lastDrawColor)
+	{
+		stats->redundantStates++;
+	}
+	lastDrawColor = color;
+
+	SDL_SetRenderDrawColor(app.renderer, r, g, b, a);
+}
+
+void setDrawBlendMode(SDL_BlendMode mode)
+{
+	RenderStats *stats = phaseStats();
+
+	stats->stateChanges++;
+	if (mode == lastDrawBlend)
+	{
+		stats->redundantStates++;
+	}
+	lastDrawBlend = mode;
+
+	SDL_SetRenderDrawBlendMode(app.renderer, mode);
+}
+
+void setTextureColor(SDL_Texture *texture, int r, int g, int b)
+{
+	RenderStats *stats = phaseStats();
+	Uint32 color;
+
+	color = (r << 16) | (g << 8) | b;
+
+	stats->stateChanges++;
+	if (texture == lastColorTexture && color == lastTextureColor)
+	{
+		stats->redundantStates++;
+	}
+	lastColorTexture = texture;
+	lastTextureColor = color;
+
+	SDL_SetTextureColorMod(texture, r, g, b);
+}
+
+void setTextureAlpha(SDL_Texture *texture, int a)
+{
+	RenderStats *stats = phaseStats();
+
+	stats->stateChanges++;
+	if (texture == lastAlphaTexture && a == lastTextureAlpha)
+	{
+		stats->redundantStates++;
+	}
+	lastAlphaTexture = texture;
+	lastTextureAlpha = a;
+
+	SDL_SetTextureAlphaMod(texture, a);
+}
+
+void setTextureBlend(SDL_Texture *texture, SDL_BlendMode mode)
+{
+	RenderStats *stats = phaseStats();
+
+	stats->stateChanges++;
+
+	SDL_SetTextureBlendMode(texture, mode);
+}
+
+static RenderStats *phaseStats(void)
+{
+	if (current == NULL)
+	{
+		setRenderPhase("other");
+	}
+
+	return &current->frame;
+}
+
+static void addStats(RenderStats *to, RenderStats *from)
+{
+	to->drawCalls += from->drawCalls;
+	to->stateChanges += from->stateChanges;
+	to->redundantStates += from->redundantStates;
+	to->textureSwitches += from->textureSwitches;
+	to->pixels += from->pixels;
+}
+
+static long coveredPixels(const SDL_Rect *rect)
+{
+	int x1, y1, x2, y2;
+
+	if (rect == NULL)
+	{
+		return SCREEN_WIDTH * (SCREEN_HEIGHT);
+	}
+
+	x1 = MAX(0, rect->x);
+	y1 = MAX(0, rect->y);
+	x2 = MIN(SCREEN_WIDTH, rect->x + rect->w);
+	y2 = MIN(SCREEN_HEIGHT, rect->y + rect->h);
+
+	return (x2 > x1 && y2 > y1) ? (long)(x2 - x1) * (y2 - y1) : 0;
+}
+
+static void writeStats(FILE *file, const char *name, RenderStats *stats, long frames, int last)
+{
+	double n;
+
+	n = MAX(1, frames);
+
+	fprintf(file, "    \"%s\": {\"drawCalls\": %.2f, \"stateChanges\": %.2f, \"redundantStates\": %.2f, \"textureSwitches\": %.2f, \"pixels\": %.0f}%s\n",
+		name, stats->drawCalls / n, stats->stateChanges / n, stats->redundantStates / n, stats->textureSwitches / n, stats->pixels / n, last ? "" : ",");
+}
@@ -0,0 +1,22 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+void beginRenderFrame(void);
+void endRenderFrame(void);
+const char *setRenderPhase(const char *name);
+void resetRenderTotals(void);
+void getRenderFrameStats(RenderStats *stats);
+void writeRenderReport(FILE *file);
+void renderClear(void);
+void renderCopy(SDL_Texture *texture, const SDL_Rect *src, const SDL_Rect *dest);
+void renderDrawLine(int x1, int y1, int x2, int y2);
+void renderFillRect(const SDL_Rect *rect);
+void setDrawColor(int r, int g, int b, int a);
+void setDrawBlendMode(SDL_BlendMode mode);
+void setTextureColor(SDL_Texture *texture, int r, int g, int b);
+void setTextureAlpha(SDL_Texture *texture, int a);
+void setTextureBlend(SDL_Texture *texture, SDL_BlendMode mode);
+
+// Attributes the render calls made inside function to a phase named after it. Needs profile.h.
+#define RENDER_PHASE(function) do { const char *_previousPhase = setRenderPhase(#function); PROFILE_CALL(function); setRenderPhase(_previousPhase); } while (0)
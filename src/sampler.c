@@ -0,0 +1,423 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+#ifdef __linux__
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <link.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+#endif
+
+#include "common.h"
+#include "sampler.h"
+
+extern App app;
+
+volatile int samplerPhase;
+
+static const char *sceneNames[] = {"title", "stage", "highscores"};
+static const char *phaseNames[PHASE_MAX] = {"init", "prepareScene", "doInput", "logic", "draw", "drawOverlay", "presentScene", "capFrameRate"};
+
+#ifdef __linux__
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+typedef struct
+{
+	uintptr_t ip;
+	unsigned char scene;
+	unsigned char phase;
+} Sample;
+
+typedef struct
+{
+	uintptr_t start;
+	uintptr_t size;
+	const char *name;
+} Symbol;
+
+static void onSample(int signal, siginfo_t *info, void *context);
+static uintptr_t sampleAddress(void *context);
+static void loadSymbols(void);
+static const char *lookupSymbol(uintptr_t ip, char *buffer, int size);
+static int compareSymbols(const void *a, const void *b);
+static int compareStrings(const void *a, const void *b);
+static void writeFolded(void);
+
+static Sample *samples;
+static volatile int sampleCount;
+static volatile int droppedSamples;
+static timer_t timer;
+static int running;
+static Symbol *symbols;
+static int symbolCount;
+static char *symbolData;
+static uintptr_t exeBase;
+static int exeIsPie;
+
+void initSampler(int argc, char *argv[])
+{
+	struct sigaction action;
+	struct sigevent event;
+	struct itimerspec interval;
+	clockid_t clock;
+	int i, hz;
+
+	hz = 0;
+
+	for (i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--sample") == 0)
+		{
+			hz = (i + 1 < argc && argv[i + 1][0] != '-') ? atoi(argv[++i]) : SAMPLER_HZ;
+		}
+	}
+
+	if (hz <= 0)
+	{
+		return;
+	}
+
+	// Faster than this the handler alone would swamp the frame.
+	if (hz > SAMPLER_MAX_HZ)
+	{
+		LOG_WARN(LOG_CAT_APP, "Sampling rate %d Hz is too high, using %d Hz.", hz, SAMPLER_MAX_HZ);
+		hz = SAMPLER_MAX_HZ;
+	}
+
+	samples = malloc(sizeof(Sample) * SAMPLER_MAX_SAMPLES);
+	if (samples == NULL)
+	{
+		LOG_ERROR(LOG_CAT_APP, "Couldn't allocate sampler buffer.");
+		return;
+	}
+
+	sampleCount = 0;
+	droppedSamples = 0;
+	samplerPhase = PHASE_INIT;
+
+	memset(&action, 0, sizeof(action));
+	action.sa_sigaction = onSample;
+	action.sa_flags = SA_SIGINFO | SA_RESTART;
+	sigemptyset(&action.sa_mask);
+	sigaction(SIGPROF, &action, NULL);
+
+	// Tick on the main thread's CPU clock and deliver to it alone, so the log and audio threads never take samples.
+	if (pthread_getcpuclockid(pthread_self(), &clock) != 0)
+	{
+		clock = CLOCK_MONOTONIC;
+	}
+
+	memset(&event, 0, sizeof(event));
+	event.sigev_notify = SIGEV_THREAD_ID;
+	event.sigev_signo = SIGPROF;
+	event.sigev_notify_thread_id = syscall(SYS_gettid);
+
+	if (timer_create(clock, &event, &timer) != 0)
+	{
+		LOG_ERROR(LOG_CAT_APP, "Couldn't create sampling timer.");
+		free(samples);
+		samples = NULL;
+		return;
+	}
+
+	// tv_nsec must stay below a second; 1 Hz is a whole second and no nanoseconds.
+	interval.it_interval.tv_sec = 1 / hz;
+	interval.it_interval.tv_nsec = (1000000000L / hz) % 1000000000L;
+	interval.it_value = interval.it_interval;
+
+	if (timer_settime(timer, 0, &interval, NULL) != 0)
+	{
+		LOG_ERROR(LOG_CAT_APP, "Couldn't start sampling timer at %d Hz.", hz);
+		timer_delete(timer);
+		signal(SIGPROF, SIG_IGN);
+		free(samples);
+		samples = NULL;
+		return;
+	}
+
+	running = 1;
+
+	LOG_INFO(LOG_CAT_APP, "Sampling profiler running at %d Hz, output %s.", hz, SAMPLER_FILENAME);
+}
+
+void shutdownSampler(void)
+{
+	if (!running)
+	{
+		return;
+	}
+
+	timer_delete(timer);
+	signal(SIGPROF, SIG_IGN);
+	running = 0;
+
+	writeFolded();
+
+	free(samples);
+	samples = NULL;
+	free(symbols);
+	symbols = NULL;
+	free(symbolData);
+	symbolData = NULL;
+}
+
+static void onSample(int signal, siginfo_t *info, void *context)
+{
+	int n;
+
+	n = sampleCount;
+
+	if (n >= SAMPLER_MAX_SAMPLES)
+	{
+		droppedSamples++;
+		return;
+	}
+
+	samples[n].ip = sampleAddress(context);
+	samples[n].scene = app.scene;
+	samples[n].phase = samplerPhase;
+
+	sampleCount = n + 1;
+}
+
+static uintptr_t sampleAddress(void *context)
+{
+	ucontext_t *uc = context;
+
+#if defined(__x86_64__)
+	return uc->uc_mcontext.gregs[REG_RIP];
+#elif defined(__i386__)
+	return uc->uc_mcontext.gregs[REG_EIP];
+#elif defined(__aarch64__)
+	return uc->uc_mcontext.pc;
+#elif defined(__arm__)
+	return uc->uc_mcontext.arm_pc;
+#else
+	return 0;
+#endif
+}
+
+static void loadSymbols(void)
+{
+	ElfW(Ehdr) *header;
+	ElfW(Shdr) *sections, *strings;
+	ElfW(Sym) *sym;
+	Dl_info self;
+	FILE *file;
+	long size;
+	int i, j, n;
+
+	if (dladdr((void *)initSampler, &self) == 0)
+	{
+		return;
+	}
+
+	exeBase = (uintptr_t)self.dli_fbase;
+
+	// Static functions never reach the dynamic symbol table, so read .symtab from our own binary.
+	file = fopen("/proc/self/exe", "rb");
+	if (file == NULL)
+	{
+		return;
+	}
+
+	fseek(file, 0, SEEK_END);
+	size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	symbolData = malloc(size);
+	if (symbolData == NULL || fread(symbolData, 1, size, file) != size)
+	{
+		fclose(file);
+		return;
+	}
+
+	fclose(file);
+
+	header = (ElfW(Ehdr) *)symbolData;
+	if (size < sizeof(*header) || memcmp(header->e_ident, ELFMAG, SELFMAG) != 0)
+	{
+		return;
+	}
+
+	exeIsPie = (header->e_type == ET_DYN);
+	sections = (ElfW(Shdr) *)(symbolData + header->e_shoff);
+
+	for (i = 0; i < header->e_shnum; i++)
+	{
+		if (sections[i].sh_type != SHT_SYMTAB)
+		{
+			continue;
+		}
+
+		strings = &sections[sections[i].sh_link];
+		n = sections[i].sh_size / sizeof(ElfW(Sym));
+
+		symbols = realloc(symbols, sizeof(Symbol) * (symbolCount + n));
+
+		for (j = 0; j < n; j++)
+		{
+			sym = (ElfW(Sym) *)(symbolData + sections[i].sh_offset) + j;
+
+			if (ELF64_ST_TYPE(sym->st_info) == STT_FUNC && sym->st_value != 0)
+			{
+				symbols[symbolCount].start = sym->st_value;
+				symbols[symbolCount].size = sym->st_size;
+				symbols[symbolCount].name = symbolData + strings->sh_offset + sym->st_name;
+				symbolCount++;
+			}
+		}
+	}
+
+	qsort(symbols, symbolCount, sizeof(Symbol), compareSymbols);
+}
+
+static const char *lookupSymbol(uintptr_t ip, char *buffer, int size)
+{
+	Dl_info info;
+	uintptr_t address;
+	int low, high, mid;
+
+	if (dladdr((void *)ip, &info) == 0)
+	{
+		snprintf(buffer, size, "[unknown]");
+		return buffer;
+	}
+
+	if ((uintptr_t)info.dli_fbase == exeBase && symbolCount > 0)
+	{
+		address = exeIsPie ? ip - exeBase : ip;
+
+		// Last symbol starting at or before the address.
+		low = 0;
+		high = symbolCount - 1;
+
+		while (low < high)
+		{
+			mid = (low + high + 1) / 2;
+
+			if (symbols[mid].start <= address)
+			{
+				low = mid;
+			}
+			else
+			{
+				high = mid - 1;
+			}
+		}
+
+		if (symbols[low].start <= address && (symbols[low].size == 0 || address < symbols[low].start + symbols[low].size))
+		{
+			return symbols[low].name;
+		}
+	}
+
+	if (info.dli_sname != NULL)
+	{
+		return info.dli_sname;
+	}
+
+	// Frame-pointer-free library code with no exported symbol: attribute it to the library.
+	snprintf(buffer, size, "[%s]", (info.dli_fname != NULL && strrchr(info.dli_fname, '/') != NULL) ? strrchr(info.dli_fname, '/') + 1 : "?");
+	return buffer;
+}
+
+static int compareSymbols(const void *a, const void *b)
+{
+	const Symbol *s1 = a;
+	const Symbol *s2 = b;
+
+	return (s1->start > s2->start) - (s1->start < s2->start);
+}
+
+static int compareStrings(const void *a, const void *b)
+{
+	return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+static void writeFolded(void)
+{
+	char symbolBuffer[MAX_LINE_LENGTH], **stacks;
+	const char *scene, *phase;
+	FILE *file;
+	int i, n, count;
+
+	n = sampleCount;
+
+	loadSymbols();
+
+	stacks = malloc(sizeof(char *) * MAX(n, 1));
+
+	for (i = 0; i < n; i++)
+	{
+		scene = (samples[i].scene < sizeof(sceneNames) / sizeof(sceneNames[0])) ? sceneNames[samples[i].scene] : "?";
+		phase = (samples[i].phase < PHASE_MAX) ? phaseNames[samples[i].phase] : "?";
+
+		stacks[i] = malloc(MAX_LINE_LENGTH);
+		snprintf(stacks[i], MAX_LINE_LENGTH, "voidfighter;%s;%s;%s", scene, phase, lookupSymbol(samples[i].ip, symbolBuffer, sizeof(symbolBuffer)));
+	}
+
+	qsort(stacks, n, sizeof(char *), compareStrings);
+
+	file = fopen(SAMPLER_FILENAME, "w");
+	if (file == NULL)
+	{
+		LOG_ERROR(LOG_CAT_APP, "Couldn't write %s.", SAMPLER_FILENAME);
+	}
+
+	// Folded stacks: one "frame;frame;frame count" line per unique stack, ready for flamegraph.pl.
+	for (i = 0; i < n; i += count)
+	{
+		for (count = 1; i + count < n && strcmp(stacks[i], stacks[i + count]) == 0; count++)
+		{
+		}
+
+		if (file != NULL)
+		{
+			fprintf(file, "%s %d\n", stacks[i], count);
+		}
+	}
+
+	for (i = 0; i < n; i++)
+	{
+		free(stacks[i]);
+	}
+
+	free(stacks);
+
+	if (file != NULL)
+	{
+		fclose(file);
+		LOG_INFO(LOG_CAT_APP, "Sampling profile written to %s (%d samples, %d dropped).", SAMPLER_FILENAME, n, droppedSamples);
+	}
+}
+
+#else
+
+void initSampler(int argc, char *argv[])
+{
+	int i;
+
+	for (i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--sample") == 0)
+		{
+			LOG_WARN(LOG_CAT_APP, "Sampling profiler is only available on Linux.");
+		}
+	}
+}
+
+void shutdownSampler(void)
+{
+}
+
+#endif
@@ -0,0 +1,11 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+void initSampler(int argc, char *argv[]);
+void shutdownSampler(void);
+
+// Read from the SIGPROF handler, so a plain store is all the main loop pays.
+extern volatile int samplerPhase;
+
+#define SET_PHASE(phase) (samplerPhase = (phase))
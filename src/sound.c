@@ -5,22 +5,39 @@ Copyright (C) 2023-2025 Asephri.net. All rights reserved.
 #include <SDL2/SDL_mixer.h>
 
 #include "common.h"
+#include "loader.h"
+#include "memtrack.h"
+#include "metrics.h"
+#include "packformat.h"
+#include "pack.h"
 #include "sound.h"
 
 static void loadSounds(void);
+static Mix_Chunk *getSound(int id);
+static void *decodeSound(const char *filename);
+
+static const char *soundFilenames[SND_MAX] = {
+    "sound/voidfighter - Track 02 (PlayerFire).ogg",
+    "sound/voidfighter - Track 03 (EnemyFire).ogg",
+    "sound/voidfighter - Track 04 (Explosion).ogg",
+    "sound/voidfighter - Track 05 (EnemyDeath).ogg",
+    "sound/voidfighter - Track 06 (points).ogg"
+};
 
 static Mix_Chunk *sounds[SND_MAX];
+static int soundJobs[SND_MAX];
 static Mix_Music *music;
 
 void initSounds(void)
 {
     memset(sounds, 0, sizeof(Mix_Chunk*) * SND_MAX);
+    memset(soundJobs, 0, sizeof(int) * SND_MAX);
 
     music = NULL;
 
     loadSounds();
 
-    printf("// Audio system initialized.\n");
+    LOG_INFO(LOG_CAT_SOUND, "Audio system initialized.");
 }
 
 void loadMusic(char *filename)
@@ -32,14 +49,14 @@ void loadMusic(char *filename)
         music = NULL;
     }
 
-    music = Mix_LoadMUS(filename);
+    MEM_SCOPE(MEM_TAG_AUDIO, music = Mix_LoadMUS(filename));
     if (music == NULL)
     {
-        fprintf(stderr, "// SDL Mixer Error: Failed to load music '%s': %s\n", filename, Mix_GetError());
+        LOG_ERROR(LOG_CAT_SOUND, "Failed to load music '%s': %s", filename, Mix_GetError());
         return;
     }
 
-    printf("// Music loaded: %s\n", filename);
+    LOG_INFO(LOG_CAT_SOUND, "Music loaded: %s", filename);
 }
 
 void playMusic(int loop)
@@ -47,41 +64,111 @@ void playMusic(int loop)
     Mix_PlayMusic(music, (loop) ? -1 : 0);
     if (music == NULL)
     {
-        fprintf(stderr, "// SDL Mixer Error: Failed to play music: %s\n", Mix_GetError());
+        LOG_ERROR(LOG_CAT_SOUND, "Failed to play music: %s", Mix_GetError());
         return;
     }
 
-    printf("// Music playing.\n");
+    LOG_INFO(LOG_CAT_SOUND, "Music playing.");
 }
 
 void playSound(int id, int channel)
 {
-    Mix_PlayChannel(channel, sounds[id], 0);
+    METRIC_ADD(METRIC_SOUNDS, 1);
+
+    Mix_PlayChannel(channel, getSound(id), 0);
     if (sounds[id] == NULL)
     {
-        fprintf(stderr, "// SDL Mixer Error: Failed to play sound effect %d: %s\n", id, Mix_GetError());
+        LOG_ERROR(LOG_CAT_SOUND, "Failed to play sound effect %d: %s", id, Mix_GetError());
         return;
     }
 
-    printf("// Sound effect %d playing on channel %d.\n", id, channel);
+    LOG_DEBUG(LOG_CAT_SOUND, "Sound effect %d playing on channel %d.", id, channel);
+}
+
+void freeSounds(void)
+{
+    int i, previousTag;
+
+    previousTag = pushMemTag(MEM_TAG_AUDIO);
+
+    Mix_HaltChannel(-1);
+    Mix_HaltMusic();
+
+    for (i = 0; i < SND_MAX; i++)
+    {
+        Mix_FreeChunk(getSound(i));
+        sounds[i] = NULL;
+    }
+
+    Mix_FreeMusic(music);
+    music = NULL;
+
+    Mix_CloseAudio();
+
+    popMemTag(previousTag);
+
+    LOG_INFO(LOG_CAT_SOUND, "Audio released.");
 }
 
 static void loadSounds(void)
 {
-    sounds[SND_PLAYER_FIRE] = Mix_LoadWAV("sound/voidfighter - Track 02 (PlayerFire).ogg");
-    sounds[SND_ENEMY_FIRE] = Mix_LoadWAV("sound/voidfighter - Track 03 (EnemyFire).ogg");
-    sounds[SND_PLAYER_DIE] = Mix_LoadWAV("sound/voidfighter - Track 04 (Explosion).ogg");
-    sounds[SND_ENEMY_DIE] = Mix_LoadWAV("sound/voidfighter - Track 05 (EnemyDeath).ogg");
-    sounds[SND_POINTS] = Mix_LoadWAV("sound/voidfighter - Track 06 (points).ogg");
-    
-    for (int i = 0; i < SND_MAX; i++)
+    int i;
+
+    // Decoded on the loader threads; each effect is collected the first time it plays.
+    for (i = 0; i < SND_MAX; i++)
     {
-        if (sounds[i] == NULL)
+        soundJobs[i] = queueLoad(decodeSound, soundFilenames[i]);
+
+        if (soundJobs[i] == 0)
         {
-            fprintf(stderr, "// SDL Mixer Error: Failed to load sound effect %d: %s\n", i, Mix_GetError());
-            continue;
+            sounds[i] = decodeSound(soundFilenames[i]);
+            LOG_INFO(LOG_CAT_SOUND, "Sound effect %d loaded.", i);
         }
+    }
+}
 
-        printf("// Sound effect %d loaded.\n", i);
+static Mix_Chunk *getSound(int id)
+{
+    if (soundJobs[id] != 0)
+    {
+        sounds[id] = waitLoad(soundJobs[id]);
+        soundJobs[id] = 0;
+
+        if (sounds[id] != NULL)
+        {
+            LOG_INFO(LOG_CAT_SOUND, "Sound effect %d loaded.", id);
+        }
     }
+
+    return sounds[id];
+}
+
+static void *decodeSound(const char *filename)
+{
+    const PackEntry *entry;
+    Mix_Chunk *chunk;
+    Uint16 format;
+    int frequency, channels;
+
+    entry = findPackEntry(filename, PACK_SOUND);
+
+    if (entry != NULL && Mix_QuerySpec(&frequency, &format, &channels) != 0)
+    {
+        // Baked in the device format, so the chunk plays straight out of the mapped pack.
+        if (entry->frequency == (Uint32)frequency && entry->format == format && entry->channels == (Uint32)channels)
+        {
+            return Mix_QuickLoad_RAW((Uint8 *)packData(entry), entry->size);
+        }
+
+        LOG_WARN(LOG_CAT_SOUND, "Packed '%s' is %u Hz, %u channels, format 0x%x but the device is %d Hz, %d channels, format 0x%x; decoding the file instead.",
+            filename, entry->frequency, entry->channels, entry->format, frequency, channels, format);
+    }
+
+    MEM_SCOPE(MEM_TAG_AUDIO, chunk = Mix_LoadWAV(filename));
+    if (chunk == NULL)
+    {
+        LOG_ERROR(LOG_CAT_SOUND, "Failed to load sound effect '%s': %s", filename, Mix_GetError());
+    }
+
+    return chunk;
 }
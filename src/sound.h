@@ -3,6 +3,7 @@ Copyright (C) 2023-2025 Asephri.net. All rights reserved.
 */
 
 void initSounds(void);
+void freeSounds(void);
 void loadMusic(char *filename);
 void playMusic(int loop);
 void playSound(int id, int channel);
\ No newline at end of file
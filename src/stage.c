@@ -5,12 +5,21 @@ Copyright (C) 2023-2025 Asephri.net. All rights reserved.
 #include "common.h"
 #include "background.h"
 #include "draw.h"
+#include "entity.h"
+#include "grid.h"
 #include "highscores.h"
 #include "sound.h"
 #include "stage.h"
 #include "text.h"
+#include "texture.h"
+#include "timer.h"
 #include "util.h"
 #include "hud.h"
+#include "memtrack.h"
+#include "metrics.h"
+#include "particle.h"
+#include "profile.h"
+#include "render.h"
 
 extern App app;
 extern Highscores highscore;
@@ -19,24 +28,30 @@ extern Stage stage;
 static void logic(void);
 static void draw(void);
 static void initPlayer(void);
-static void fireBullet(void);
+static void fireBullet(int p);
 static void doPlayer(void);
 static void doFighters(void);
 static void doBullets(void);
 static void drawFighters(void);
 static void drawBullets(void);
-static void spawnEnemies(void);
-static int bulletHitFighter(Entity *b);
-static void doEnemies(void);
-static void fireEnemyBullet(Entity *e);
+static void spawnEnemies(EntityId id);
+static int bulletHitFighter(int b);
+static void enemyReloaded(EntityId id);
+static void fireEnemyBullet(int e, int p);
 static void clipPlayer(void);
 static void clipEnemies(void);
 static void checkPlayerEnemyCollisions(void);
+static void buildFighterGrid(void);
+static void addContact(int kind, EntityId target, float x, float y);
+static void resolveContacts(void);
+static void emitHitEffects(Contact *c, int e);
+static int compareContacts(const void *a, const void *b);
 static void resetStage(void);
+static void requestStageTextures(void);
 static void drawExplosions(void);
 static void doExplosions(void);
 static void addExplosions(int x, int y, int num);
-static void addDebris(Entity *e);
+static void addDebris(Transform *t, int texture);
 static void doDebris(void);
 static void drawDebris(void);
 static void drawtrails(void);
@@ -44,1135 +59,1229 @@ static void dotrails(void);
 static void addtrails(int x, int y, int num);
 static void drawfire(void);
 static void dofire(void);
-static void addfire(Entity *e);
+static void addfire(Transform *t);
+static Uint32 randomGlowColor(void);
 static void doPointsSphere(void);
 static void addPointsSphere(int x, int y);
+static void pointsExpired(EntityId id);
+static void stageOver(EntityId id);
 static void drawPointsSphere(void);
 static void drawHudText(void);
-
-static Entity *player;
-static SDL_Texture *bulletTexture;
-static SDL_Texture *enemyTexture;
-static SDL_Texture *EnemyBulletTexture;
-static SDL_Texture *playerTexture;
-static SDL_Texture *background;
-static SDL_Texture *explosionTexture;
-static SDL_Texture *trailTexture;
-static SDL_Texture *fireTexture;
-static SDL_Texture* pointsTexture;
-static int enemySpawnTimer;
-static int stageResetTimer;
+static void drawEntities(Archetype *archetype);
+
+static EntityId player;
+static int bulletTexture;
+static int enemyTexture;
+static int EnemyBulletTexture;
+static int playerTexture;
+static int background;
+static int explosionTexture;
+static int trailTexture;
+static int fireTexture;
+static int pointsTexture;
+static int pointsTextures[POINTS_TEXTURES];
 static int POINT_RESULT_BUFFER;
+static Archetype fighters;
+static Archetype bullets;
+static Archetype points;
+static SpatialGrid fighterGrid;
+static SpatialGrid pointGrid;
+static Contact *contacts;
+static int numContacts;
+static ParticleSystem explosions;
+static ParticleSystem debris;
+static ParticleSystem trails;
+static ParticleSystem fires;
 int HUD_HEALTH_BUFFER[3];
 
 void initStage(void)
 {
+    int i, previous;
+
+    previous = app.scene;
+
     app.delegate.logic = logic;
     app.delegate.draw = draw;
+    app.scene = SCENE_STAGE;
+
+    LOG_INFO(LOG_CAT_STAGE, "Initializing the stage...");
+
+    // Allocated once per session; every later spawn is a row in these tables.
+    if (fighters.id == NULL)
+    {
+        initEntities(ARCHETYPE_FIGHTERS + ARCHETYPE_BULLETS + ARCHETYPE_POINTS);
+        initArchetype(&fighters, "fighters", COMP_TRANSFORM | COMP_VELOCITY | COMP_SPRITE | COMP_HEALTH | COMP_RELOAD | COMP_SIDE, ARCHETYPE_FIGHTERS, METRIC_FIGHTERS);
+        initArchetype(&bullets, "bullets", COMP_TRANSFORM | COMP_VELOCITY | COMP_SPRITE | COMP_SIDE, ARCHETYPE_BULLETS, METRIC_BULLETS);
+        initArchetype(&points, "points", COMP_TRANSFORM | COMP_VELOCITY | COMP_SPRITE | COMP_EXPIRY, ARCHETYPE_POINTS, METRIC_POINTS);
+
+        initGrid(&fighterGrid, "fighters", &fighters);
+        initGrid(&pointGrid, "points", &points);
+
+        // A bullet makes at most one contact and an enemy at most one crash, so this never fills.
+        contacts = memAlloc(sizeof(Contact) * (ARCHETYPE_BULLETS + ARCHETYPE_FIGHTERS), MEM_TAG_POOLS);
+
+        initParticles(&explosions, "explosions", PARTICLES_EXPLOSIONS, PARTICLE_GLOW, 0, 0, METRIC_EXPLOSIONS);
+        initParticles(&trails, "trails", PARTICLES_TRAILS, PARTICLE_GLOW, 0, 0, METRIC_TRAILS);
+        initParticles(&debris, "debris", PARTICLES_DEBRIS, 0, -0.35, 0.25, METRIC_DEBRIS);
+        initParticles(&fires, "fire", PARTICLES_FIRE, 0, -0.35, 0.25, METRIC_FIRE);
+    }
 
-    printf("Initializing the stage...\n");
+    // Coming back from the highscore table or a benchmark restart: release the previous run's entities first.
+    resetStage();
 
     memset(&stage, 0, sizeof(Stage));
-    stage.fighterTail = &stage.fighterHead;
-    stage.bulletTail = &stage.bulletHead;
-    stage.explosionTail = &stage.explosionHead;
-    stage.debrisTail = &stage.debrisHead;
-    stage.trailTail = &stage.trailHead;
-    stage.fireTail = &stage.fireHead;
-    stage.pointsTail = &stage.pointsHead;
-
-    printf("Loading textures...\n");
-    bulletTexture = loadTexture("gfx/playerBullet.png");
-    enemyTexture = loadTexture("gfx/enemy.png");
-    EnemyBulletTexture = loadTexture("gfx/enemyBullet.png");
-    playerTexture = loadTexture("gfx/player.png");
-    background = loadTexture("gfx/background.png");
-    explosionTexture = loadTexture("gfx/explosion.png");
-    trailTexture = loadTexture("gfx/trail.png");
-    fireTexture = loadTexture("gfx/fire.png");
-    pointsTexture = loadTexture("gfx/points.png");
+
+    for (i = METRIC_FIGHTERS; i <= METRIC_POINTS; i++)
+    {
+        METRIC_SET(i, 0);
+    }
+
+    LOG_INFO(LOG_CAT_STAGE, "Loading textures...");
+    requestStageTextures();
+
+    // Usually prefetched from the title screen; whatever is still decoding is waited for here.
+    finishTextures(SCENE_STAGE);
+
+    // Loaded first, so anything the stage shares with the previous scene never drops to zero references.
+    if (previous != app.scene)
+    {
+        releaseTextures(previous);
+    }
 
     //loadMusic("music/voidfighter - Track 01 (deepspace-01).ogg");
 
     //playMusic(1);
 
-    printf("Stage initialization completed!\n");
+    LOG_INFO(LOG_CAT_STAGE, "Stage initialization completed!");
 
-    resetStage();
 	stage.score = 0;
 
 	initPlayer();
 
-	enemySpawnTimer = 0;
+	clearTimers();
 
-	stageResetTimer = FPS * 3;
+	scheduleTimer(1, spawnEnemies, ENTITY_NONE);
 }
 
-static void resetStage(void)
+// Starts decoding the stage's textures in the background so initStage() finds them ready.
+void prefetchStage(void)
 {
-    Entity *e;
-    Explosion *ex;
-    Debris *d;
-    trail *tr;
-    fire *f;
+    requestStageTextures();
+}
 
-    printf("Resetting the stage...\n");
+static void requestStageTextures(void)
+{
+    char filename[MAX_LINE_LENGTH];
+    int i;
 
-    while (stage.fighterHead.next)
-    {
-        e = stage.fighterHead.next;
-        stage.fighterHead.next = e->next;
-        free(e);
-    }
+    bulletTexture = requestTexture("gfx/playerBullet.png", SCENE_STAGE);
+    enemyTexture = requestTexture("gfx/enemy.png", SCENE_STAGE);
+    EnemyBulletTexture = requestTexture("gfx/enemyBullet.png", SCENE_STAGE);
+    playerTexture = requestTexture("gfx/player.png", SCENE_STAGE);
+    background = requestTexture("gfx/background.png", SCENE_STAGE);
+    explosionTexture = requestTexture("gfx/explosion.png", SCENE_STAGE);
+    trailTexture = requestTexture("gfx/trail.png", SCENE_STAGE);
+    fireTexture = requestTexture("gfx/fire.png", SCENE_STAGE);
 
-    while (stage.bulletHead.next)
-    {
-        e = stage.bulletHead.next;
-        stage.bulletHead.next = e->next;
-        free(e);
-    }
+    requestHud(SCENE_STAGE);
 
-    while (stage.explosionHead.next)
-    {
-        ex = stage.explosionHead.next;
-        stage.explosionHead.next = ex->next;
-        free(ex);
-    }
-    while (stage.debrisHead.next != NULL)
-    {
-        d = stage.debrisHead.next;
-        stage.debrisHead.next = d->next;
-        free(d);
-    }
-    while (stage.trailHead.next)
+    // Index n is the countdown sprite gfx/points<n>.png; 0 is the full-value gfx/points.png.
+    pointsTextures[0] = requestTexture("gfx/points.png", SCENE_STAGE);
+
+    for (i = 1; i < POINTS_TEXTURES; i++)
     {
-        tr = stage.trailHead.next;
-        stage.trailHead.next = tr->next;
-        free(tr);
+        snprintf(filename, sizeof(filename), "gfx/points%d.png", i);
+        pointsTextures[i] = requestTexture(filename, SCENE_STAGE);
     }
-    while (stage.fireHead.next)
+
+    pointsTexture = pointsTextures[0];
+}
+
+static void resetStage(void)
+{
+    int live;
+
+    LOG_INFO(LOG_CAT_STAGE, "Resetting the stage...");
+
+    clearArchetype(&fighters);
+    clearArchetype(&bullets);
+    clearArchetype(&points);
+
+    player = ENTITY_NONE;
+
+    clearParticles(&explosions);
+    clearParticles(&debris);
+    clearParticles(&trails);
+    clearParticles(&fires);
+
+    // Every archetype is cleared above, so any slot still held belongs to one resetStage doesn't know about.
+    live = countEntities();
+    if (live > 0)
     {
-        f = stage.fireHead.next;
-        stage.fireHead.next = f->next;
-        free(f);
+        LOG_WARN(LOG_CAT_STAGE, "Leak: %d entities still hold slots after stage reset.", live);
     }
 
-    stage.fighterTail = &stage.fighterHead;
-	stage.bulletTail = &stage.bulletHead;
-	stage.explosionTail = &stage.explosionHead;
-	stage.debrisTail = &stage.debrisHead;
-	stage.pointsTail = &stage.pointsHead;
-
-    printf("Stage reset completed!\n");
+    LOG_INFO(LOG_CAT_STAGE, "Stage reset completed!");
 }
 
 static void initPlayer()
 {
-    printf("Initializing the player...\n");
+    Transform *t;
+    int p;
+
+    LOG_INFO(LOG_CAT_STAGE, "Initializing the player...");
 
-    player = malloc(sizeof(Entity));
-    memset(player, 0, sizeof(Entity));
-    stage.fighterTail->next = player;
-    stage.fighterTail = player;
+    // The fighter archetype was just cleared, so this can't fail.
+    p = spawnEntity(&fighters, &player);
+    t = &fighters.transform[p];
 
-    player->health = 25;
-    player->x = 100;
-    player->y = (SCREEN_HEIGHT - HUD_HEIGHT)  /2;
-    player->texture = playerTexture;
-    SDL_QueryTexture(player->texture, NULL, NULL, &player->w, &player->h);
-    player->side = SIDE_PLAYER;
+    fighters.health[p] = 25;
+    t->x = 100;
+    t->y = (SCREEN_HEIGHT - HUD_HEIGHT)  /2;
+    fighters.sprite[p] = playerTexture;
+    getTextureSize(playerTexture, &t->w, &t->h);
+    fighters.side[p] = SIDE_PLAYER;
 
-    printf("Player initialized successfully!\n");
+    LOG_INFO(LOG_CAT_STAGE, "Player initialized successfully!");
 }
 
 static void logic(void)
 {
-    printf("Running logic...\n");
-
-    doBackground();
-    doStars();
-    doHud();
-    doPlayer();
-    doEnemies();
-    doFighters();
-    doPointsSphere();
-    doBullets();
-    doExplosions();
-    doDebris();
-    dotrails();
-    dofire();
-    spawnEnemies();
-    clipPlayer();
-    clipEnemies();
-    checkPlayerEnemyCollisions();
-
-    if (player == NULL && --stageResetTimer <= 0)
-    {
-        addHighscore(stage.score);
-
-        printf("Stage reset initiated.\n");
-
-        initHighscores();
-    }
-
-    printf("Logic completed.\n");
+    LOG_TRACE(LOG_CAT_STAGE, "Running logic...");
+
+    numContacts = 0;
+
+    PROFILE_CALL(doBackground);
+    PROFILE_CALL(doStars);
+    PROFILE_CALL(doHud);
+    PROFILE_CALL(doPlayer);
+    PROFILE_CALL(doFighters);
+    PROFILE_CALL(doPointsSphere);
+    PROFILE_CALL(buildFighterGrid);
+    PROFILE_CALL(doBullets);
+    PROFILE_CALL(doExplosions);
+    PROFILE_CALL(doDebris);
+    PROFILE_CALL(dotrails);
+    PROFILE_CALL(dofire);
+    PROFILE_CALL(clipPlayer);
+    PROFILE_CALL(clipEnemies);
+    PROFILE_CALL(buildFighterGrid);
+    PROFILE_CALL(checkPlayerEnemyCollisions);
+    PROFILE_CALL(resolveContacts);
+
+    LOG_TRACE(LOG_CAT_STAGE, "Logic completed.");
 }
 
 static void doPlayer(void)
 {
-    printf("Handling player actions...\n");
+    LOG_TRACE(LOG_CAT_STAGE, "Handling player actions...");
 
-    if (player != NULL)
+    Transform *t;
+    Velocity *v;
+    int p;
+
+    p = entityRow(player, &fighters);
+
+    if (p >= 0)
     {
-        player->dx = player->dy = 0;
-        player->x = player->x - PLAYER_PUSHBACK;
+        t = &fighters.transform[p];
+        v = &fighters.velocity[p];
 
-        if (player->reload > 0)
-        {
-            player->reload--;
-        }
+        v->dx = v->dy = 0;
+        t->x = t->x - PLAYER_PUSHBACK;
 
         if (app.keyboard[SDL_SCANCODE_UP])
         {
-            player->dy = -PLAYER_SPEED;
-            printf("Player moving up.\n");
+            v->dy = -PLAYER_SPEED;
+            LOG_TRACE(LOG_CAT_STAGE, "Player moving up.");
         }
 
         if (app.keyboard[SDL_SCANCODE_DOWN])
         {
-            player->dy = PLAYER_SPEED;
-            printf("Player moving down.\n");
+            v->dy = PLAYER_SPEED;
+            LOG_TRACE(LOG_CAT_STAGE, "Player moving down.");
         }
 
         if (app.keyboard[SDL_SCANCODE_LEFT])
         {
-            player->dx = -PLAYER_SPEED;
-            printf("Player moving left.\n");
+            v->dx = -PLAYER_SPEED;
+            LOG_TRACE(LOG_CAT_STAGE, "Player moving left.");
         }
 
         if (app.keyboard[SDL_SCANCODE_RIGHT])
         {
-            player->dx = PLAYER_SPEED + 2.5;
-            addtrails((player->x - 1), player->y, 32);
-            printf("Player moving right.\n");
+            v->dx = PLAYER_SPEED + 2.5;
+            addtrails((t->x - 1), t->y, 32);
+            LOG_TRACE(LOG_CAT_STAGE, "Player moving right.");
         }
 
-        if (app.keyboard[SDL_SCANCODE_LCTRL] && player->reload <= 0)
+        // The player's reload holds the tick it may fire again rather than a countdown.
+        if (app.keyboard[SDL_SCANCODE_LCTRL] && (int)getTimerTick() >= fighters.reload[p])
         {
             playSound(SND_PLAYER_FIRE, CH_PLAYER);
-            fireBullet();
-            printf("Player fired a bullet.\n");
+            fireBullet(p);
+            LOG_DEBUG(LOG_CAT_STAGE, "Player fired a bullet.");
 
-            player->reload = PLAYER_FIRE_COOLDOWN;
+            fighters.reload[p] = getTimerTick() + PLAYER_FIRE_COOLDOWN;
         }
     }
 
-    printf("Player actions handled.\n");
+    LOG_TRACE(LOG_CAT_STAGE, "Player actions handled.");
 }
 
-static void fireBullet(void)
+static void fireBullet(int p)
 {
-    printf("Firing player bullet...\n");
+    LOG_TRACE(LOG_CAT_STAGE, "Firing player bullet...");
 
-    Entity *bullet = malloc(sizeof(Entity));
-    memset(bullet, 0, sizeof(Entity));
-    stage.bulletTail->next = bullet;
-    stage.bulletTail = bullet;
+    Transform *t;
+    int b;
 
-    bullet->x = player->x;
-    bullet->y = player->y - bullet->h;
-    bullet->dx = PLAYER_BULLET_SPEED;
-    bullet->health = 1;
-    bullet->texture = bulletTexture;
-    bullet->side = SIDE_PLAYER;
+    b = spawnEntity(&bullets, NULL);
+    if (b < 0)
+    {
+        return;
+    }
+
+    t = &bullets.transform[b];
 
-    SDL_QueryTexture(bullet->texture, NULL, NULL, &bullet->w, &bullet->h);
+    t->x = fighters.transform[p].x;
+    t->y = fighters.transform[p].y;
+    bullets.velocity[b].dx = PLAYER_BULLET_SPEED;
+    bullets.sprite[b] = bulletTexture;
+    bullets.side[b] = SIDE_PLAYER;
 
-    player->reload = PLAYER_RELOAD_TIME;
+    getTextureSize(bulletTexture, &t->w, &t->h);
 
-    printf("Player bullet fired.\n");
+    fighters.reload[p] = getTimerTick() + PLAYER_RELOAD_TIME;
+
+    LOG_TRACE(LOG_CAT_STAGE, "Player bullet fired.");
 }
 
-static void doEnemies(void)
+static void enemyReloaded(EntityId id)
 {
-    printf("Handling enemy actions...\n");
+    int e, p;
 
-    Entity *e;
+    e = entityRow(id, &fighters);
+    p = entityRow(player, &fighters);
 
-    for (e = stage.fighterHead.next; e != NULL; e = e->next)
+    // Dead enemies just let their timer lapse; once the player is gone nobody fires again.
+    if (e < 0 || p < 0)
     {
-        if (e != player && player != NULL && --e->reload <= 0)
-        {
-            fireEnemyBullet(e);
-            playSound(SND_ENEMY_FIRE, CH_ENEMY_FIRE);
-            printf("Enemy fired a bullet.\n");
-        }
+        return;
     }
 
-    printf("Enemy actions handled.\n");
+    fireEnemyBullet(e, p);
+    playSound(SND_ENEMY_FIRE, CH_ENEMY_FIRE);
+    LOG_DEBUG(LOG_CAT_STAGE, "Enemy fired a bullet.");
 }
 
-static void fireEnemyBullet(Entity *e)
+static void fireEnemyBullet(int e, int p)
 {
-	Entity *bullet;
+	Transform *t, *from, *to;
+	Velocity *v;
+	int b;
+
+    LOG_TRACE(LOG_CAT_STAGE, "Enemy bullet created.");
+	b = spawnEntity(&bullets, NULL);
+	if (b < 0)
+	{
+		scheduleTimer(1, enemyReloaded, fighters.id[e]);
+		return;
+	}
 
-    printf("Enemy bullet created.\n");
-	bullet = malloc(sizeof(Entity));
-	memset(bullet, 0, sizeof(Entity));
-	stage.bulletTail->next = bullet;
-	stage.bulletTail = bullet;
+	t = &bullets.transform[b];
+	v = &bullets.velocity[b];
+	from = &fighters.transform[e];
+	to = &fighters.transform[p];
 
-	bullet->x = e->x;
-	bullet->y = e->y;
-	bullet->health = 1;
-	bullet->texture = EnemyBulletTexture;
-	bullet->side = SIDE_ENEMY;
-	SDL_QueryTexture(bullet->texture, NULL, NULL, &bullet->w, &bullet->h);
+	t->x = from->x;
+	t->y = from->y;
+	bullets.sprite[b] = EnemyBulletTexture;
+	bullets.side[b] = SIDE_ENEMY;
+	getTextureSize(EnemyBulletTexture, &t->w, &t->h);
 
-	bullet->x += (e->w / 2) - (bullet->w / 2);
-	bullet->y += (e->h / 2) - (bullet->h / 2);
+	t->x += (from->w / 2) - (t->w / 2);
+	t->y += (from->h / 2) - (t->h / 2);
 
-	calcSlope(player->x + (player->w / 2), player->y + (player->h / 2), e->x, e->y, &bullet->dx, &bullet->dy);
-    printf("Bullet path to player calculated..\n");
-	bullet->dx *= ENEMY_BULLET_SPEED;
-	bullet->dy *= ENEMY_BULLET_SPEED;
+	calcSlope(to->x + (to->w / 2), to->y + (to->h / 2), from->x, from->y, &v->dx, &v->dy);
+    LOG_TRACE(LOG_CAT_STAGE, "Bullet path to player calculated..");
+	v->dx *= ENEMY_BULLET_SPEED;
+	v->dy *= ENEMY_BULLET_SPEED;
 
-	e->reload = (rand() % FPS * 2);
+	fighters.reload[e] = (rand() % FPS * 2);
+	scheduleTimer(fighters.reload[e], enemyReloaded, fighters.id[e]);
 
-    printf("Enemy bullet fired.\n");
+    LOG_TRACE(LOG_CAT_STAGE, "Enemy bullet fired.");
 }
 
 static void doFighters(void)
 {
-    printf("Updating fighter entities...\n");
+    LOG_TRACE(LOG_CAT_STAGE, "Updating fighter entities...");
 
-    Entity *e, *prev;
+    Transform *t;
+    Velocity *v;
+    int i;
 
-    prev = &stage.fighterHead;
+    i = 0;
 
-    for (e = stage.fighterHead.next; e != NULL; e = e->next)
+    while (i < fighters.count)
     {
-        e->x += e->dx;
-        e->y += e->dy;
+        t = &fighters.transform[i];
+        v = &fighters.velocity[i];
+
+        t->x += v->dx;
+        t->y += v->dy;
 
-        if (e != player && e->x < -e->w)
+        if (fighters.id[i] != player && t->x < -t->w)
         {
-            e->health = 0;
+            fighters.health[i] = 0;
         }
 
-        if (e->health == 0)
+        if (fighters.health[i] == 0)
         {
-            if (e == player)
+            if (fighters.id[i] == player)
             {
-                player = NULL;
-            }
+                player = ENTITY_NONE;
+                scheduleTimer(STAGE_OVER_DELAY, stageOver, ENTITY_NONE);
 
-            if (e == stage.fighterTail)
-            {
-                stage.fighterTail = prev;
+                // The highscore table follows; its screens decode during the delay.
+                prefetchHighscores();
             }
 
-            prev->next = e->next;
-            free(e);
-            e = prev;
+            // The last fighter moves into this row and is updated next.
+            despawnEntity(&fighters, i);
+            continue;
         }
 
-        if (e != player)
+        if (fighters.id[i] != player)
         {
-            e->dy = sin(SDL_GetTicks() / FPS / 2) * ENEMY_SPEED;
+            v->dy = sin(getGameTicks() / FPS / 2) * ENEMY_SPEED;
         }
-        prev = e;
+
+        i++;
     }
 
-    printf("Fighter entities updated.\n");
+    LOG_TRACE(LOG_CAT_STAGE, "Fighter entities updated.");
 }
 
 static void doBullets(void)
 {
-    printf("Updating bullet entities...\n");
+    LOG_TRACE(LOG_CAT_STAGE, "Updating bullet entities...");
 
-    Entity *b, *prev;
+    Transform *t;
+    Velocity *v;
+    int i;
 
-    prev = &stage.bulletHead;
+    i = 0;
 
-    for (b = stage.bulletHead.next; b != NULL; b = b->next)
+    while (i < bullets.count)
     {
-        b->x += b->dx;
-        b->y += b->dy;
+        t = &bullets.transform[i];
+        v = &bullets.velocity[i];
 
-        if (bulletHitFighter(b) || b->x < -b->w || b->y < -b->h || b->x > SCREEN_WIDTH || b->y > (SCREEN_HEIGHT - HUD_HEIGHT))
-        {
-            if (b == stage.bulletTail)
-            {
-                stage.bulletTail = prev;
-            }
+        t->x += v->dx;
+        t->y += v->dy;
 
-            prev->next = b->next;
-            free(b);
-            b = prev;
-            printf("Bullet hit an enemy or went out of bounds. Bullet removed.\n");
+        if (bulletHitFighter(i) || t->x < -t->w || t->y < -t->h || t->x > SCREEN_WIDTH || t->y > (SCREEN_HEIGHT - HUD_HEIGHT))
+        {
+            despawnEntity(&bullets, i);
+            LOG_DEBUG(LOG_CAT_STAGE, "Bullet hit an enemy or went out of bounds. Bullet removed.");
+            continue;
         }
 
-        prev = b;
+        i++;
     }
 
-    printf("Bullet entities updated.\n");
+    LOG_TRACE(LOG_CAT_STAGE, "Bullet entities updated.");
 }
 
 static void addExplosions(int x, int y, int num)
 {
-    printf("Adding explosions...\n");
+    LOG_TRACE(LOG_CAT_STAGE, "Adding explosions...");
 
-    Explosion *e;
-    int i;
-
-    for (i = 0; i < num; i++)
-    {
-        e = malloc(sizeof(Explosion));
-        memset(e, 0, sizeof(Explosion));
-        stage.explosionTail->next = e;
-        stage.explosionTail = e;
+    int i, first, n;
 
-        e->x = x + (rand() % 32) - (rand() % 32);
-        e->y = y + (rand() % 32) - (rand() % 32);
-        e->dx = (rand() % 10) - (rand() % 10);
-        e->dy = (rand() % 10) - (rand() % 10);
-
-        e->dx /= 10;
-        e->dy /= 10;
-
-        switch (rand() % 4)
-        {
-            case 0:
-                e->r = 255;
-                break;
-
-            case 1:
-                e->r = 255;
-                e->g = 128;
-                break;
-
-            case 2:
-                e->r = 255;
-                e->g = 255;
-                break;
-
-            default:
-                e->r = 255;
-                e->g = 255;
-                e->b = 255;
-                break;
-        }
+    n = emitParticles(&explosions, num, &first);
 
-        e->a = rand() % FPS * 3;
+    for (i = first; i < first + n; i++)
+    {
+        explosions.x[i] = x + (rand() % 32) - (rand() % 32);
+        explosions.y[i] = y + (rand() % 32) - (rand() % 32);
+        explosions.dx[i] = ((rand() % 10) - (rand() % 10)) / 10.0f;
+        explosions.dy[i] = -((rand() % 10) - (rand() % 10)) / 10.0f;
+        explosions.color[i] = randomGlowColor();
+        explosions.life[i] = rand() % FPS * 3;
+        explosions.texture[i] = explosionTexture;
     }
 
-    printf("Explosions added.\n");
+    LOG_TRACE(LOG_CAT_STAGE, "Explosions added.");
 }
 
-static void addDebris(Entity *e)
+static void addDebris(Transform *t, int texture)
 {
-    printf("Adding debris from bullet collision...\n");
+    LOG_TRACE(LOG_CAT_STAGE, "Adding debris from bullet collision...");
+
+    int i, first, n, w, h;
 
-    Debris *d;
-    int x, y, w, h;
+    w = t->w / 2;
+    h = t->h / 2;
 
-    w = e->w / 2;
-    h = e->h / 2;
+    // One particle per quarter of the sprite.
+    n = emitParticles(&debris, 4, &first);
 
-    for (y = 0; y <= h; y += h)
+    for (i = first; i < first + n; i++)
     {
-        for (x = 0; x <= w; x += w)
-        {
-            d = malloc(sizeof(Debris));
-            memset(d, 0, sizeof(Debris));
-            stage.debrisTail->next = d;
-            stage.debrisTail = d;
-            d->x = e->x + e->w / 2;
-            d->y = e->y + e->h / 2;
-            d->dx = -5 - (rand() % 5);
-            d->dy = -5 - (rand() % 6);
-            d->life = FPS * 2;
-            d->texture = e->texture;
-
-            d->rect.x = x;
-            d->rect.y = y;
-            d->rect.w = w;
-            d->rect.h = h;
-        }
+        debris.x[i] = t->x + t->w / 2;
+        debris.y[i] = t->y + t->h / 2;
+        debris.dx[i] = -5 - (rand() % 5);
+        debris.dy[i] = -5 - (rand() % 6);
+        debris.life[i] = FPS * 2;
+        debris.texture[i] = texture;
+        debris.src[i].x = ((i - first) % 2) * w;
+        debris.src[i].y = ((i - first) / 2) * h;
+        debris.src[i].w = w;
+        debris.src[i].h = h;
     }
 
-    printf("Debris added.\n");
+    LOG_TRACE(LOG_CAT_STAGE, "Debris added.");
 }
 
 static void addtrails(int x, int y, int num)
 {
-    printf("Adding trails...\n");
+    LOG_TRACE(LOG_CAT_STAGE, "Adding trails...");
 
-    trail *e;
-    int i;
+    int i, first, n;
 
-    for (i = 0; i < num; i++)
+    // Only ever one trail particle per call, whatever num asks for.
+    n = emitParticles(&trails, MIN(num, 1), &first);
+
+    for (i = first; i < first + n; i++)
     {
-        if (i >= 1)
-            break;
+        trails.x[i] = x;
+        trails.y[i] = y;
+        trails.dx[i] = 0;
+        trails.dy[i] = -((rand() % 5) - (rand() % 5)) / 5.0f;
+        trails.color[i] = randomGlowColor();
+        trails.life[i] = rand() % FPS * 1.85;
+        trails.texture[i] = trailTexture;
+    }
 
-        e = malloc(sizeof(trail));
-        memset(e, 0, sizeof(trail));
-        stage.trailTail->next = e;
-        stage.trailTail = e;
+    LOG_TRACE(LOG_CAT_STAGE, "Trails added.");
+}
 
-        e->x = x;
-        e->y = y;
-        e->dy = (rand() % 5) - (rand() % 5);
+static void addfire(Transform *t)
+{
+    LOG_TRACE(LOG_CAT_STAGE, "Adding fire...");
 
-        e->dy /= 5;
+    int i, first, n, w, h;
 
-        switch (rand() % 4)
-        {
-            case 0:
-                e->r = 255;
-                break;
-
-            case 1:
-                e->r = 255;
-                e->g = 128;
-                break;
-
-            case 2:
-                e->r = 255;
-                e->g = 255;
-                break;
-
-            default:
-                e->r = 255;
-                e->g = 255;
-                e->b = 255;
-                break;
-        }
+    w = t->w / 2;
+    h = t->h / 2;
 
-        e->a = rand() % FPS * 1.85;
+    n = emitParticles(&fires, 4, &first);
+
+    for (i = first; i < first + n; i++)
+    {
+        fires.x[i] = t->x + t->w / 2;
+        fires.y[i] = t->y + t->h / 2;
+        fires.dx[i] = -5 - (rand() % 5);
+        fires.dy[i] = -(5 + (rand() % 16));
+        fires.life[i] = FPS * 2;
+        fires.texture[i] = fireTexture;
+        fires.src[i].x = ((i - first) % 2) * w;
+        fires.src[i].y = ((i - first) / 2) * h;
+        fires.src[i].w = w;
+        fires.src[i].h = h;
     }
 
-    printf("Trails added.\n");
+    LOG_TRACE(LOG_CAT_STAGE, "Fire added.");
 }
 
-static void addfire(Entity *e)
+static Uint32 randomGlowColor(void)
 {
-    printf("Adding fire...\n");
+    switch (rand() % 4)
+    {
+        case 0:
+            return PARTICLE_RGB(255, 0, 0);
 
-    fire *f;
-    int x, y, w, h;
+        case 1:
+            return PARTICLE_RGB(255, 128, 0);
 
-    w = e->w / 2;
-    h = e->h / 2;
+        case 2:
+            return PARTICLE_RGB(255, 255, 0);
 
-    for (y = 0; y <= h; y += h)
-    {
-        for (x = 0; x <= w; x += w)
-        {
-            f = malloc(sizeof(fire));
-            memset(f, 0, sizeof(fire));
-            stage.fireTail->next = f;
-            stage.fireTail = f;
-            f->x = e->x + e->w / 2;
-            f->y = e->y + e->h / 2;
-            f->dx = -5 - (rand() % 5);
-            f->dy = -(5 + (rand() % 16));
-            f->life = FPS * 2;
-            f->texture = e->texture;
-            f->rect.x = x;
-            f->rect.y = y;
-            f->rect.w = w;
-            f->rect.h = h;
-        }
+        default:
+            return PARTICLE_RGB(255, 255, 255);
     }
-
-    printf("Fire added.\n");
 }
 
-static int bulletHitFighter(Entity *b)
+static int bulletHitFighter(int b)
 {
-    printf("Checking if a bullet hits a fighter...\n");
-
-    Entity *e;
+    LOG_TRACE(LOG_CAT_STAGE, "Checking if a bullet hits a fighter...");
 
-    for (e = stage.fighterHead.next; e != NULL; e = e->next)
-    {
-        if (e->side != b->side && collision(b->x, b->y, b->w, b->h, e->x, e->y, e->w, e->h))
-        {
-            b->health = 0;
-            e->health -= 1;
+    Transform *bt, *t;
+    float time;
+    int e, k, n;
 
-            addExplosions(e->x, e->y, 32);
+    bt = &bullets.transform[b];
 
-            if (e == player)
-            {
-                playSound(SND_PLAYER_DIE, CH_PLAYER);
-                printf("Player hit by a bullet.\n");
-            }
-            else
-            {
-                stage.score = stage.score + 1;
-                addPointsSphere(e->x + e->w / 2, e->y + e->h / 2);
-                playSound(SND_ENEMY_DIE, CH_ANY);
-                printf("Enemy hit by a bullet. Score increased.\n");
-            }
+    // Only the other side's fighters near the bullet's path this tick are tested, so a fast
+    // bullet can't step over one. Of several on the path, the one it reached first is hit;
+    // of several reached at once, the lowest row, as when every fighter was walked in order.
+    n = sweepGrid(&fighterGrid, (bullets.side[b] == SIDE_PLAYER) ? SIDE_ENEMY : SIDE_PLAYER, bt, bullets.sprite[b], &bullets.velocity[b]);
+    e = -1;
+    time = 0;
 
-            int i;
+    for (k = 0; k < n; k++)
+    {
+        if (e < 0 || fighterGrid.times[k] < time || (fighterGrid.times[k] == time && fighterGrid.found[k] < e))
+        {
+            e = fighterGrid.found[k];
+            time = fighterGrid.times[k];
+        }
+    }
 
-            for (i = 0; i <= 2; i++)
-            {
-                addfire(e);
-            }
+    if (e >= 0)
+    {
+        t = &fighters.transform[e];
 
-            for (i = 0; i <= 1; i++)
-            {
-                addDebris(e);
-            }
+        addContact(CONTACT_BULLET, fighters.id[e], t->x, t->y);
 
-            printf("Bullet hit a fighter. Explosions, fire, and debris added.\n");
+        LOG_TRACE(LOG_CAT_STAGE, "Bullet hit a fighter %.2f of the way through the tick.", time);
 
-            return 1;
-        }
+        return 1;
     }
 
-    printf("No fighter hit by the bullet.\n");
+    LOG_TRACE(LOG_CAT_STAGE, "No fighter hit by the bullet.");
 
     return 0;
 }
 
 static void doPointsSphere(void)
 {
-    printf("Updating point spheres...\n");
-
-    Entity *e, *prev;
+    LOG_TRACE(LOG_CAT_STAGE, "Updating point spheres...");
 
-    prev = &stage.pointsHead;
+    Transform *t, *pt;
+    Velocity *v;
+    int i, k, n, p, row;
 
-    for (e = stage.pointsHead.next; e != NULL; e = e->next)
+    for (i = 0; i < points.count; i++)
     {
-        if (e->x < 32)
+        t = &points.transform[i];
+        v = &points.velocity[i];
+
+        if (t->x < 32)
         {
-            e->x = 32;
-            e->dx = -e->dx;
+            t->x = 32;
+            v->dx = -v->dx;
         }
 
-        if (e->x + e->w > 928)
+        if (t->x + t->w > 928)
         {
-            e->x = 928 - e->w;
-            e->dx = -e->dx;
+            t->x = 928 - t->w;
+            v->dx = -v->dx;
         }
 
-        if (e->y < 32)
+        if (t->y < 32)
         {
-            e->y = 32;
-            e->dy = -e->dy;
+            t->y = 32;
+            v->dy = -v->dy;
         }
 
-        if (e->y + e->h > 672)
+        if (t->y + t->h > 672)
         {
-            e->y = 672 - e->h;
-            e->dy = -e->dy;
+            t->y = 672 - t->h;
+            v->dy = -v->dy;
         }
 
-        e->x += e->dx;
-        e->y += e->dy;
+        t->x += v->dx;
+        t->y += v->dy;
+    }
 
-        if (player != NULL && collision(e->x, e->y, e->w, e->h, player->x, player->y, player->w, player->h))
-        {
-            e->health = 0;
+    p = entityRow(player, &fighters);
 
-            stage.score += POINT_RESULT_BUFFER;
+    if (p < 0)
+    {
+        LOG_TRACE(LOG_CAT_STAGE, "Point spheres updated.");
+        return;
+    }
 
-            playSound(SND_POINTS, CH_POINTS);
+    pt = &fighters.transform[p];
 
-            printf("Player collected a point sphere. Score increased.\n");
-        }
+    buildGrid(&pointGrid);
 
-        if (--e->health <= 0)
-        {
-            if (e == stage.pointsTail)
-            {
-                stage.pointsTail = prev;
-            }
+    n = overlapGrid(&pointGrid, 0, pt, fighters.sprite[p]);
 
-            prev->next = e->next;
-            free(e);
-            e = prev;
-            printf("Point sphere removed due to health reaching 0.\n");
+    // Collected rows go highest first, so each swap-remove only moves a row that stays.
+    for (k = 1; k < n; k++)
+    {
+        row = pointGrid.found[k];
+
+        for (i = k; i > 0 && pointGrid.found[i - 1] < row; i--)
+        {
+            pointGrid.found[i] = pointGrid.found[i - 1];
         }
 
-        prev = e;
+        pointGrid.found[i] = row;
     }
 
-    printf("Point spheres updated.\n");
+    for (k = 0; k < n; k++)
+    {
+        stage.score += POINT_RESULT_BUFFER;
+
+        playSound(SND_POINTS, CH_POINTS);
+
+        LOG_DEBUG(LOG_CAT_STAGE, "Player collected a point sphere. Score increased.");
+
+        // Its expiry timer will find the handle stale and do nothing.
+        despawnEntity(&points, pointGrid.found[k]);
+    }
+
+    LOG_TRACE(LOG_CAT_STAGE, "Point spheres updated.");
 }
 
 static void addPointsSphere(int x, int y)
 {
-    printf("Adding a point sphere...\n");
+    LOG_TRACE(LOG_CAT_STAGE, "Adding a point sphere...");
+
+    Transform *t;
+    EntityId id;
+    int e;
+
+    e = spawnEntity(&points, &id);
+    if (e < 0)
+    {
+        return;
+    }
+
+    t = &points.transform[e];
+
+    t->x = x;
+    t->y = y;
+    points.velocity[e].dx = -(rand() % 5);
+    points.velocity[e].dy = (rand() % 5);
+    points.expires[e] = getTimerTick() + FPS * 10;
+    scheduleTimer(FPS * 10, pointsExpired, id);
+    points.sprite[e] = pointsTexture;
 
-    Entity *e;
+    getTextureSize(pointsTexture, &t->w, &t->h);
 
-    e = malloc(sizeof(Entity));
-    memset(e, 0, sizeof(Entity));
-    stage.pointsTail->next = e;
-    stage.pointsTail = e;
+    t->x -= t->w / 2;
+    t->y -= t->h / 2;
 
-    e->x = x;
-    e->y = y;
-    e->dx = -(rand() % 5);
-    e->dy = (rand() % 5);
-    e->health = FPS * 10;
-    e->texture = pointsTexture;
-    e->side = SIDE_ENEMY;
+    LOG_TRACE(LOG_CAT_STAGE, "Point sphere added.");
+}
 
-    SDL_QueryTexture(e->texture, NULL, NULL, &e->w, &e->h);
+static void pointsExpired(EntityId id)
+{
+    int e;
 
-    e->x -= e->w / 2;
-    e->y -= e->h / 2;
+    e = entityRow(id, &points);
 
-    printf("Point sphere added.\n");
+    if (e >= 0)
+    {
+        despawnEntity(&points, e);
+        LOG_DEBUG(LOG_CAT_STAGE, "Point sphere removed after its lifetime ran out.");
+    }
 }
 
-static void spawnEnemies(void)
+static void spawnEnemies(EntityId id)
 {
-    printf("Spawning enemy entities...\n");
+    LOG_TRACE(LOG_CAT_STAGE, "Spawning enemy entities...");
 
-    Entity *enemy;
+    Transform *t;
+    Velocity *v;
+    int e;
 
-    if (--enemySpawnTimer <= 0)
+    e = spawnEntity(&fighters, NULL);
+    if (e < 0)
     {
-        enemy = malloc(sizeof(Entity));
-        memset(enemy, 0, sizeof(Entity));
-        stage.fighterTail->next = enemy;
-        stage.fighterTail = enemy;
+        scheduleTimer(1, spawnEnemies, ENTITY_NONE);
+        return;
+    }
 
-        enemy->x = HUDSCREEN_WIDTH;
-        enemy->y = rand() % HUDSCREEN_HEIGHT;
-        enemy->texture = enemyTexture;
-        SDL_QueryTexture(enemy->texture, NULL, NULL, &enemy->w, &enemy->h);
+    t = &fighters.transform[e];
+    v = &fighters.velocity[e];
 
-        enemy->dx = -(2 + (rand() % 4));
-        enemy->dy = -100 + (rand() % 200);
-		enemy->dy /= 100;
+    t->x = HUDSCREEN_WIDTH;
+    t->y = rand() % HUDSCREEN_HEIGHT;
+    fighters.sprite[e] = enemyTexture;
+    getTextureSize(enemyTexture, &t->w, &t->h);
 
-        enemy->side = SIDE_ENEMY;
-        enemy->health = 1;
+    v->dx = -(2 + (rand() % 4));
+    v->dy = -100 + (rand() % 200);
+	v->dy /= 100;
 
-        enemy->reload = FPS * (1 + (rand() % 3));
+    fighters.side[e] = SIDE_ENEMY;
+    fighters.health[e] = 1;
 
-        enemySpawnTimer = ENEMY_SPAWN_TIME + (rand() % FPS);
+    fighters.reload[e] = FPS * (1 + (rand() % 3));
+    scheduleTimer(fighters.reload[e], enemyReloaded, fighters.id[e]);
 
-        printf("Enemy spawned");
-    }
+    scheduleTimer(ENEMY_SPAWN_TIME + (rand() % FPS), spawnEnemies, ENTITY_NONE);
+
+    LOG_DEBUG(LOG_CAT_STAGE, "Enemy spawned");
+}
+
+static void stageOver(EntityId id)
+{
+    addHighscore(stage.score);
+
+    LOG_INFO(LOG_CAT_STAGE, "Stage reset initiated.");
+
+    initHighscores();
 }
 
 static void clipPlayer(void)
 {
-    printf("Clipping the player's position within the screen...\n");
+    LOG_TRACE(LOG_CAT_STAGE, "Clipping the player's position within the screen...");
+
+    Transform *t;
+    int p;
+
+    p = entityRow(player, &fighters);
 
-    if (player != NULL)
+    if (p >= 0)
     {
-        if (player->x < HUDSCREEN_X)
+        t = &fighters.transform[p];
+
+        if (t->x < HUDSCREEN_X)
         {
-            player->x = HUDSCREEN_X;
-            printf("Player's x-coordinate clipped to HUDSCREEN_X.\n");
+            t->x = HUDSCREEN_X;
+            LOG_TRACE(LOG_CAT_STAGE, "Player's x-coordinate clipped to HUDSCREEN_X.");
         }
 
-        if (player->y < HUDSCREEN_Y)
+        if (t->y < HUDSCREEN_Y)
         {
-            player->y = HUDSCREEN_Y;
-            printf("Player's y-coordinate clipped to HUDSCREEN_Y.\n");
+            t->y = HUDSCREEN_Y;
+            LOG_TRACE(LOG_CAT_STAGE, "Player's y-coordinate clipped to HUDSCREEN_Y.");
         }
 
-        if (player->x > SCREEN_WIDTH / 2 - SCREEN_BOUNDS * 4)
+        if (t->x > SCREEN_WIDTH / 2 - SCREEN_BOUNDS * 4)
         {
-            player->x = SCREEN_WIDTH / 2 - SCREEN_BOUNDS * 4;
-            printf("Player's x-coordinate clipped to the left side of the screen bounds.\n");
+            t->x = SCREEN_WIDTH / 2 - SCREEN_BOUNDS * 4;
+            LOG_TRACE(LOG_CAT_STAGE, "Player's x-coordinate clipped to the left side of the screen bounds.");
         }
 
-        if (player->y > HUDSCREEN_HEIGHT)
+        if (t->y > HUDSCREEN_HEIGHT)
         {
-            player->y = HUDSCREEN_HEIGHT;
-            printf("Player's y-coordinate clipped to HUDSCREEN_HEIGHT.\n");
+            t->y = HUDSCREEN_HEIGHT;
+            LOG_TRACE(LOG_CAT_STAGE, "Player's y-coordinate clipped to HUDSCREEN_HEIGHT.");
         }
     }
 
-    printf("Player position clipped.\n");
+    LOG_TRACE(LOG_CAT_STAGE, "Player position clipped.");
 }
 
 static void clipEnemies(void)
 {
-    printf("Clipping enemy positions within the screen...\n");
+    LOG_TRACE(LOG_CAT_STAGE, "Clipping enemy positions within the screen...");
 
-    Entity *e;
+    Transform *t;
+    int i;
 
-    for (e = stage.fighterHead.next; e != NULL; e = e->next)
+    for (i = 0; i < fighters.count; i++)
     {
-        if (e != player)
+        if (fighters.id[i] != player)
         {
-            if (e->x < HUDSCREEN_X)
+            t = &fighters.transform[i];
+
+            if (t->x < HUDSCREEN_X)
             {
-                e->health = 0;
+                fighters.health[i] = 0;
 
-                printf("Enemy removed from the game: out of left bounds.\n");
+                LOG_DEBUG(LOG_CAT_STAGE, "Enemy removed from the game: out of left bounds.");
             }
 
-            if (e->y < HUDSCREEN_Y)
+            if (t->y < HUDSCREEN_Y)
             {
-                e->y = HUDSCREEN_Y;
-                printf("Enemy clipped to HUDSCREEN_Y: out of top bounds.\n");
+                t->y = HUDSCREEN_Y;
+                LOG_TRACE(LOG_CAT_STAGE, "Enemy clipped to HUDSCREEN_Y: out of top bounds.");
             }
 
-            if (e->x > HUDSCREEN_WIDTH)
+            if (t->x > HUDSCREEN_WIDTH)
             {
-                e->x = HUDSCREEN_WIDTH;
-                printf("Enemy clipped to HUDSCREEN_WIDTH: out of right bounds.\n");
+                t->x = HUDSCREEN_WIDTH;
+                LOG_TRACE(LOG_CAT_STAGE, "Enemy clipped to HUDSCREEN_WIDTH: out of right bounds.");
             }
 
-            if (e->y > HUDSCREEN_HEIGHT)
+            if (t->y > HUDSCREEN_HEIGHT)
             {
-                e->y = HUDSCREEN_HEIGHT;
-                printf("Enemy clipped to HUDSCREEN_HEIGHT: out of bottom bounds.\n");
+                t->y = HUDSCREEN_HEIGHT;
+                LOG_TRACE(LOG_CAT_STAGE, "Enemy clipped to HUDSCREEN_HEIGHT: out of bottom bounds.");
             }
         }
     }
 
-    printf("All enemy positions clipped within the screen.\n");
+    LOG_TRACE(LOG_CAT_STAGE, "All enemy positions clipped within the screen.");
 }
 
 static void checkPlayerEnemyCollisions(void)
 {
-    Entity *e;
+    Transform *t, *pt;
+    int e, k, n, p;
+
+    p = entityRow(player, &fighters);
 
-    for (e = stage.fighterHead.next; e != NULL; e = e->next)
+    if (p < 0)
     {
-        if (e != player && player != NULL && collision(player->x, player->y, player->w, player->h, e->x, e->y, e->w, e->h))
-        {
-            player->health = 0;
-            e->health = 0;
-
-            int i;
-            for (i = 0; i <= 76; i++) // 76.25 frames (human reaction time on average).
-            { 
-                playSound(SND_PLAYER_DIE, CH_ANY);
-                addExplosions(e->x, e->y, 4);
-            }
-        }
+        return;
     }
 
-    printf("Fighter collision check completed.\n");
-}
+    pt = &fighters.transform[p];
 
-static void doExplosions(void)
-{
-    Explosion *e, *prev;
-
-    prev = &stage.explosionHead;
+    n = overlapGrid(&fighterGrid, SIDE_ENEMY, pt, fighters.sprite[p]);
 
-    for (e = stage.explosionHead.next; e != NULL; e = e->next)
+    for (k = 0; k < n; k++)
     {
-        e->x += e->dx;
-        e->y -= e->dy;
-
-        if (--e->a <= 0)
-        {
-            if (e == stage.explosionTail)
-            {
-                stage.explosionTail = prev;
-            }
+        e = fighterGrid.found[k];
+        t = &fighters.transform[e];
 
-            prev->next = e->next;
-            free(e);
-            e = prev;
-        }
-        prev = e;
+        addContact(CONTACT_CRASH, fighters.id[e], t->x, t->y);
     }
 
-    printf("Explosions updated.\n");
+    LOG_TRACE(LOG_CAT_STAGE, "Fighter collision check completed.");
 }
 
-static void doDebris(void)
+static void buildFighterGrid(void)
 {
-	Debris *d, *prev;
-
-	prev = &stage.debrisHead;
+    buildGrid(&fighterGrid);
+}
 
-	for (d = stage.debrisHead.next; d != NULL; d = d->next)
-	{
-		d->x += d->dx;
-		d->y += d->dy;
+static void addContact(int kind, EntityId target, float x, float y)
+{
+    Contact *c;
 
-		d->dy += 0.25;
-        d->dx -= 0.35;
+    c = &contacts[numContacts++];
 
-		if (--d->life <= 0)
-		{
-			if (d == stage.debrisTail)
-			{
-				stage.debrisTail = prev;
-			}
+    c->kind = kind;
+    c->target = target;
+    c->x = x;
+    c->y = y;
+    c->spot = ((Uint32)MAX(x / CONTACT_MERGE_SIZE + 1, 0) << 16) | (Uint32)MAX(y / CONTACT_MERGE_SIZE + 1, 0);
+}
 
-			prev->next = d->next;
-			free(d);
-			d = prev;
-		}
+// Detection only records contacts; this applies them. Sorted by kind, spot and target, hits on
+// one fighter are adjacent and are applied together, and fighters hit at the same spot share
+// one burst of particles. Each sound plays at most once per frame, however many hits asked for it.
+static void resolveContacts(void)
+{
+    Contact *c;
+    int i, j, e, p, hits, effects, channels[SND_MAX], requested[SND_MAX];
 
-		prev = d;
-	}
+    if (numContacts == 0)
+    {
+        return;
+    }
 
-    printf("Debris updated.\n");
-}
+    METRIC_ADD(METRIC_CONTACTS, numContacts);
 
-static void dotrails(void)
-{
-    trail *e, *prev;
+    qsort(contacts, numContacts, sizeof(Contact), compareContacts);
 
-    prev = &stage.trailHead;
+    memset(channels, 0, sizeof(channels));
+    memset(requested, 0, sizeof(requested));
+    effects = 0;
+    p = entityRow(player, &fighters);
 
-    for (e = stage.trailHead.next; e != NULL; e = e->next)
+    for (i = 0; i < numContacts; i = j)
     {
-        e->x += e->dx;
-        e->y -= e->dy;
+        c = &contacts[i];
+        j = i + 1;
 
-        if (--e->a <= 0)
+        while (j < numContacts && contacts[j].target == c->target && contacts[j].kind == c->kind)
         {
-            if (e == stage.trailTail)
-            {
-                stage.trailTail = prev;
-            }
-
-            prev->next = e->next;
-            free(e);
-            e = prev;
+            j++;
         }
-        prev = e;
-    }
 
-    printf("Trails updated.\n");
-}
+        hits = j - i;
+        e = entityRow(c->target, &fighters);
 
-static void dofire(void)
-{
-    fire *f, *prev;
-
-    prev = &stage.fireHead;
+        if (e < 0)
+        {
+            continue;
+        }
 
-    for (f = stage.fireHead.next; f != NULL; f = f->next)
-    {
-        f->x += f->dx;
-        f->y += f->dy;
+        if (c->kind == CONTACT_CRASH)
+        {
+            if (p >= 0)
+            {
+                fighters.health[p] = 0;
+            }
 
-        f->dy += 0.25;
-        f->dx -= 0.35;
+            fighters.health[e] = 0;
+            channels[SND_PLAYER_DIE] = CH_ANY;
+            requested[SND_PLAYER_DIE] = 1;
+        }
+        else if (fighters.id[e] == player)
+        {
+            // Clamped: doFighters despawns at exactly zero.
+            fighters.health[e] = MAX(fighters.health[e] - hits, 0);
+            channels[SND_PLAYER_DIE] = CH_PLAYER;
+            requested[SND_PLAYER_DIE] = 1;
 
-        if (--f->life <= 0)
+            LOG_DEBUG(LOG_CAT_STAGE, "Player hit by %d bullets.", hits);
+        }
+        else
         {
-            if (f == stage.fireTail)
+            fighters.health[e] = MAX(fighters.health[e] - hits, 0);
+            stage.score += hits;
+            channels[SND_ENEMY_DIE] = CH_ANY;
+            requested[SND_ENEMY_DIE] = 1;
+
+            LOG_DEBUG(LOG_CAT_STAGE, "Enemy hit by %d bullets. Score increased.", hits);
+
+            // Score and point spheres stay one per hit; only the effects are merged.
+            while (hits-- > 0)
             {
-                stage.fireTail = prev;
+                addPointsSphere(c->x + fighters.transform[e].w / 2, c->y + fighters.transform[e].h / 2);
             }
+        }
 
-            prev->next = f->next;
-            free(f);
-            f = prev;
+        if (i == 0 || c->spot != contacts[i - 1].spot || c->kind != contacts[i - 1].kind)
+        {
+            emitHitEffects(c, e);
+            effects++;
         }
+    }
 
-        prev = f;
+    for (i = 0; i < SND_MAX; i++)
+    {
+        if (requested[i])
+        {
+            playSound(i, channels[i]);
+        }
     }
 
-    printf("Fire updated.\n");
+    METRIC_ADD(METRIC_CONTACT_EFFECTS, effects);
+
+    LOG_TRACE(LOG_CAT_STAGE, "%d contacts resolved into %d effects.", numContacts, effects);
 }
 
-static void drawFighters(void)
+static void emitHitEffects(Contact *c, int e)
 {
-    Entity *e;
+    Transform t;
+    int i;
 
-    for (e = stage.fighterHead.next; e != NULL; e = e->next)
+    t = fighters.transform[e];
+    t.x = c->x;
+    t.y = c->y;
+
+    if (c->kind == CONTACT_CRASH)
+    {
+        addExplosions(t.x, t.y, CRASH_EXPLOSIONS);
+        return;
+    }
+
+    addExplosions(t.x, t.y, 32);
+
+    for (i = 0; i <= 2; i++)
     {
-        blit(e->texture, e->x, e->y);
+        addfire(&t);
     }
 
-    printf("Fighters rendered.\n");
+    for (i = 0; i <= 1; i++)
+    {
+        addDebris(&t, fighters.sprite[e]);
+    }
 }
 
-static void drawBullets(void)
+static int compareContacts(const void *a, const void *b)
 {
-    Entity *b;
+    const Contact *x, *y;
+
+    x = a;
+    y = b;
 
-    for (b = stage.bulletHead.next; b != NULL; b = b->next)
+    if (x->kind != y->kind)
     {
-        blit(b->texture, b->x, b->y);
+        return x->kind - y->kind;
     }
 
-    printf("Bullets rendered.\n");
+    if (x->spot != y->spot)
+    {
+        return (x->spot < y->spot) ? -1 : 1;
+    }
+
+    if (x->target != y->target)
+    {
+        return (x->target < y->target) ? -1 : 1;
+    }
+
+    return 0;
 }
 
-static void drawDebris(void)
+static void doExplosions(void)
 {
-    Debris *d;
+    updateParticles(&explosions);
 
-    for (d = stage.debrisHead.next; d != NULL; d = d->next)
-    {
-        blitRect(d->texture, &d->rect, d->x, d->y);
-    }
+    LOG_TRACE(LOG_CAT_STAGE, "Explosions updated.");
+}
 
-    printf("Debris rendered.\n");
+static void doDebris(void)
+{
+    updateParticles(&debris);
+
+    LOG_TRACE(LOG_CAT_STAGE, "Debris updated.");
 }
 
-static void drawExplosions(void)
+static void dotrails(void)
 {
-    Explosion *e;
+    updateParticles(&trails);
 
-    SDL_SetRenderDrawBlendMode(app.renderer, SDL_BLENDMODE_ADD);
-    SDL_SetTextureBlendMode(explosionTexture, SDL_BLENDMODE_ADD);
+    LOG_TRACE(LOG_CAT_STAGE, "Trails updated.");
+}
 
-    for (e = stage.explosionHead.next; e != NULL; e = e->next)
-    {
-        SDL_SetTextureColorMod(explosionTexture, e->r, e->g, e->b);
-        SDL_SetTextureAlphaMod(explosionTexture, e->a);
+static void dofire(void)
+{
+    updateParticles(&fires);
 
-        blit(explosionTexture, e->x, e->y);
-    }
+    LOG_TRACE(LOG_CAT_STAGE, "Fire updated.");
+}
 
-    SDL_SetRenderDrawBlendMode(app.renderer, SDL_BLENDMODE_NONE);
+static void drawFighters(void)
+{
+    drawEntities(&fighters);
 
-    printf("Explosions rendered.\n");
+    LOG_TRACE(LOG_CAT_STAGE, "Fighters rendered.");
 }
 
-static void drawtrails(void)
+static void drawBullets(void)
 {
-    trail *e;
+    drawEntities(&bullets);
 
-    SDL_SetRenderDrawBlendMode(app.renderer, SDL_BLENDMODE_ADD);
-    SDL_SetTextureBlendMode(trailTexture, SDL_BLENDMODE_ADD);
+    LOG_TRACE(LOG_CAT_STAGE, "Bullets rendered.");
+}
 
-    for (e = stage.trailHead.next; e != NULL; e = e->next)
-    {
-        SDL_SetTextureColorMod(trailTexture, e->r, e->g, e->b);
-        SDL_SetTextureAlphaMod(trailTexture, e->a);
+static void drawDebris(void)
+{
+    drawParticles(&debris);
 
-        blit(trailTexture, e->x, e->y);
-    }
-    SDL_SetRenderDrawBlendMode(app.renderer, SDL_BLENDMODE_NONE);
+    LOG_TRACE(LOG_CAT_STAGE, "Debris rendered.");
+}
+
+static void drawExplosions(void)
+{
+    drawParticles(&explosions);
 
-    printf("Trails rendered.\n");
+    LOG_TRACE(LOG_CAT_STAGE, "Explosions rendered.");
 }
 
-static void drawfire(void)
+static void drawtrails(void)
 {
-    fire *f;
+    drawParticles(&trails);
 
-    for (f = stage.fireHead.next; f != NULL; f = f->next)
-    {
-        blitRect(fireTexture, &f->rect, f->x, f->y);
-    }
+    LOG_TRACE(LOG_CAT_STAGE, "Trails rendered.");
+}
+
+static void drawfire(void)
+{
+    drawParticles(&fires);
 
-    printf("Fire rendered.\n");
+    LOG_TRACE(LOG_CAT_STAGE, "Fire rendered.");
 }
 
 static void drawPointsSphere(void)
 {
-    Entity *e;
+    int i;
 
-    for (e = stage.pointsHead.next; e != NULL; e = e->next)
+    for (i = 0; i < points.count; i++)
     {
         int POINTHEALTH;
         int POINT_RESULT;
-        POINTHEALTH = e->health;
+        POINTHEALTH = points.expires[i] - getTimerTick();
 
-        blit(e->texture, e->x, e->y);
+        blit(getTexture(points.sprite[i]), points.transform[i].x, points.transform[i].y);
 
-        //drawText(e->x, e->y, 255, 255, 255, "Health: %d", POINTHEALTH);
+        //drawText(points.transform[i].x, points.transform[i].y, 255, 255, 255, "Health: %d", POINTHEALTH);
 
         switch (POINTHEALTH)
         {
         case 600:
-            pointsTexture = loadTexture("gfx/points.png");
-            e->texture = pointsTexture;
+            pointsTexture = pointsTextures[0];
+            points.sprite[i] = pointsTexture;
             POINT_RESULT = 10;
             POINT_RESULT_BUFFER = POINT_RESULT;
             break;
         case 540:
-            pointsTexture = loadTexture("gfx/points10.png");
-            e->texture = pointsTexture;
+            pointsTexture = pointsTextures[10];
+            points.sprite[i] = pointsTexture;
             POINT_RESULT = 9;
             POINT_RESULT_BUFFER = POINT_RESULT;
             break;
         case 480:
-            pointsTexture = loadTexture("gfx/points9.png");
-            e->texture = pointsTexture;
+            pointsTexture = pointsTextures[9];
+            points.sprite[i] = pointsTexture;
             POINT_RESULT = 8;
             POINT_RESULT_BUFFER = POINT_RESULT;
             break;
         case 420:
-            pointsTexture = loadTexture("gfx/points8.png");
-            e->texture = pointsTexture;
+            pointsTexture = pointsTextures[8];
+            points.sprite[i] = pointsTexture;
             POINT_RESULT = 7;
             POINT_RESULT_BUFFER = POINT_RESULT;
             break;
         case 360:
-            pointsTexture = loadTexture("gfx/points7.png");
-            e->texture = pointsTexture;
+            pointsTexture = pointsTextures[7];
+            points.sprite[i] = pointsTexture;
             POINT_RESULT = 6;
             POINT_RESULT_BUFFER = POINT_RESULT;
             break;
         case 300:
-            pointsTexture = loadTexture("gfx/points6.png");
-            e->texture = pointsTexture;
+            pointsTexture = pointsTextures[6];
+            points.sprite[i] = pointsTexture;
             POINT_RESULT = 5;
             POINT_RESULT_BUFFER = POINT_RESULT;
             break;
         case 240:
-            pointsTexture = loadTexture("gfx/points5.png");
-            e->texture = pointsTexture;
+            pointsTexture = pointsTextures[5];
+            points.sprite[i] = pointsTexture;
             POINT_RESULT = 4;
             POINT_RESULT_BUFFER = POINT_RESULT;
             break;
         case 180:
-            pointsTexture = loadTexture("gfx/points4.png");
-            e->texture = pointsTexture;
+            pointsTexture = pointsTextures[4];
+            points.sprite[i] = pointsTexture;
             POINT_RESULT = 3;
             POINT_RESULT_BUFFER = POINT_RESULT;
             break;
         case 120:
-            pointsTexture = loadTexture("gfx/points3.png");
-            e->texture = pointsTexture;
+            pointsTexture = pointsTextures[3];
+            points.sprite[i] = pointsTexture;
             POINT_RESULT = 2;
             POINT_RESULT_BUFFER = POINT_RESULT;
             break;
         case 60:
-            pointsTexture = loadTexture("gfx/points2.png");
-            e->texture = pointsTexture;
+            pointsTexture = pointsTextures[2];
+            points.sprite[i] = pointsTexture;
             POINT_RESULT = 1;
             POINT_RESULT_BUFFER = POINT_RESULT;
             break;
         case 30:
-            pointsTexture = loadTexture("gfx/points1.png");
-            e->texture = pointsTexture;
+            pointsTexture = pointsTextures[1];
+            points.sprite[i] = pointsTexture;
             POINT_RESULT = 1;
             POINT_RESULT_BUFFER = POINT_RESULT;
             break;
         }
     }
-    printf("Point spheres rendered.\n");
+    LOG_TRACE(LOG_CAT_STAGE, "Point spheres rendered.");
 }
 
 static void drawHudText(void)
 {
     drawText(HUD_SCORE_POS_WIDTH, HUD_SCORE_POS_HEIGHT, 255, 255, 255, "SCORE: %03d", stage.score);
 
-    int HUDHEALTH;
+    int HUDHEALTH, p;
+
+    p = entityRow(player, &fighters);
 
-    if (player == NULL)
+    if (p < 0)
     {
         HUDHEALTH = 0;
     }
     else
     {
-        HUDHEALTH = player->health;
+        HUDHEALTH = fighters.health[p];
     }
 
     switch (HUDHEALTH)
@@ -1247,23 +1356,53 @@ static void drawHudText(void)
         drawText(HUD_HIGHSCORE_POS_WIDTH, HUD_HIGHSCORE_POS_HEIGHT, 255, 255, 255, "HIGH SCORE: %03d", stage.score);
     }
 
-    printf("HUD text rendered.\n");
+    LOG_TRACE(LOG_CAT_STAGE, "HUD text rendered.");
 }
 
 static void draw(void)
 {
-    drawBackground();
-    drawStars();
-    drawPointsSphere();
-    drawFighters();
-    drawDebris();
-    drawExplosions();
-    drawtrails();
-    drawfire();
-    drawBullets();
-    drawHud();
-    drawHudText();
-    drawHudEffects();
-
-    printf("Rendering completed.\n");
-}
\ No newline at end of file
+    RENDER_PHASE(drawBackground);
+    RENDER_PHASE(drawStars);
+    RENDER_PHASE(drawPointsSphere);
+    RENDER_PHASE(drawFighters);
+    RENDER_PHASE(drawDebris);
+    RENDER_PHASE(drawExplosions);
+    RENDER_PHASE(drawtrails);
+    RENDER_PHASE(drawfire);
+    RENDER_PHASE(drawBullets);
+    RENDER_PHASE(drawHud);
+    RENDER_PHASE(drawHudText);
+    RENDER_PHASE(drawHudEffects);
+
+    LOG_TRACE(LOG_CAT_STAGE, "Rendering completed.");
+}
+
+static void drawEntities(Archetype *archetype)
+{
+    int i;
+
+    for (i = 0; i < archetype->count; i++)
+    {
+        blit(getTexture(archetype->sprite[i]), archetype->transform[i].x, archetype->transform[i].y);
+    }
+}
+
+void shutdownStage(void)
+{
+    resetStage();
+
+    destroyArchetype(&fighters);
+    destroyArchetype(&bullets);
+    destroyArchetype(&points);
+    destroyGrid(&fighterGrid);
+    destroyGrid(&pointGrid);
+
+    memFree(contacts);
+    contacts = NULL;
+    destroyEntities();
+
+    destroyParticles(&explosions);
+    destroyParticles(&debris);
+    destroyParticles(&trails);
+    destroyParticles(&fires);
+}
@@ -2,4 +2,6 @@
 Copyright (C) 2023-2025 Asephri.net. All rights reserved.
 */
 
-void initStage(void);
\ No newline at end of file
+void initStage(void);
+void prefetchStage(void);
+void shutdownStage(void);
\ No newline at end of file
@@ -0,0 +1,206 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+#include "common.h"
+#include "startup.h"
+#include "util.h"
+
+// Records where launch time goes, from main() to the first presented frame. Thread 0 is the
+// main thread; loader threads are 1 and up. The result is written once as a Chrome trace and
+// summarised in the log; nothing is recorded after that.
+
+typedef struct
+{
+	const char *name;
+	int thread;
+	int depth;
+	Uint64 start;
+	Uint64 end;
+	SDL_atomic_t ready;
+} StartupSpan;
+
+static int reserveSpan(void);
+static void writeTimeline(Uint64 end);
+
+static StartupSpan spans[STARTUP_MAX_SPANS];
+static SDL_atomic_t spanCount;
+static SDL_atomic_t finished;
+static int open[STARTUP_MAX_DEPTH];
+static int depth;
+static Uint64 origin;
+
+void initStartup(void)
+{
+	origin = SDL_GetPerformanceCounter();
+}
+
+void startupBegin(const char *name)
+{
+	int index;
+
+	index = (depth < STARTUP_MAX_DEPTH) ? reserveSpan() : -1;
+
+	if (index >= 0)
+	{
+		spans[index].name = name;
+		spans[index].thread = 0;
+		spans[index].depth = depth;
+		spans[index].start = SDL_GetPerformanceCounter();
+		spans[index].end = 0;
+		SDL_AtomicSet(&spans[index].ready, 1);
+	}
+
+	if (depth < STARTUP_MAX_DEPTH)
+	{
+		open[depth] = index;
+	}
+
+	depth++;
+}
+
+void startupEnd(void)
+{
+	if (depth == 0)
+	{
+		return;
+	}
+
+	depth--;
+
+	if (depth < STARTUP_MAX_DEPTH && open[depth] >= 0)
+	{
+		spans[open[depth]].end = SDL_GetPerformanceCounter();
+	}
+}
+
+void startupSpan(const char *name, int thread, Uint64 start, Uint64 end)
+{
+	int index;
+
+	index = reserveSpan();
+
+	if (index >= 0)
+	{
+		spans[index].name = name;
+		spans[index].thread = thread;
+		spans[index].depth = 0;
+		spans[index].start = start;
+		spans[index].end = end;
+		SDL_AtomicSet(&spans[index].ready, 1);
+	}
+}
+
+void finishStartup(void)
+{
+	StartupSpan *span;
+	double total, ms, busy[LOADER_MAX_THREADS + 1];
+	int jobs[LOADER_MAX_THREADS + 1];
+	Uint64 end;
+	int i, count;
+
+	if (!SDL_AtomicCAS(&finished, 0, 1))
+	{
+		return;
+	}
+
+	end = SDL_GetPerformanceCounter();
+	total = ticksToMs(end - origin);
+	count = MIN(SDL_AtomicGet(&spanCount), STARTUP_MAX_SPANS);
+
+	writeTimeline(end);
+
+	LOG_INFO(LOG_CAT_APP, "Startup: first frame presented %.1f ms after launch. Timeline written to %s.", total, STARTUP_FILENAME);
+
+	memset(busy, 0, sizeof(busy));
+	memset(jobs, 0, sizeof(jobs));
+
+	for (i = 0; i < count; i++)
+	{
+		span = &spans[i];
+
+		if (!SDL_AtomicGet(&span->ready))
+		{
+			continue;
+		}
+
+		ms = ticksToMs(((span->end != 0) ? span->end : end) - span->start);
+
+		// Top-level steps and the one level below them; the trace has the rest.
+		if (span->thread == 0 && span->depth <= 1)
+		{
+			LOG_INFO(LOG_CAT_APP, "  %*s%-*s %8.2f ms %5.1f%%", span->depth * 2, "", 24 - span->depth * 2, span->name, ms, 100.0 * ms / total);
+		}
+		else if (span->thread > 0 && span->thread <= LOADER_MAX_THREADS)
+		{
+			busy[span->thread] += ms;
+			jobs[span->thread]++;
+		}
+	}
+
+	for (i = 1; i <= LOADER_MAX_THREADS; i++)
+	{
+		if (jobs[i] > 0)
+		{
+			LOG_INFO(LOG_CAT_APP, "  loader %d: %d assets decoded, %.2f ms busy", i, jobs[i], busy[i]);
+		}
+	}
+}
+
+static int reserveSpan(void)
+{
+	int index;
+
+	if (SDL_AtomicGet(&finished))
+	{
+		return -1;
+	}
+
+	index = SDL_AtomicAdd(&spanCount, 1);
+
+	return (index < STARTUP_MAX_SPANS) ? index : -1;
+}
+
+static void writeTimeline(Uint64 end)
+{
+	FILE *file;
+	StartupSpan *span;
+	double frequency;
+	int i, count;
+
+	file = fopen(STARTUP_FILENAME, "w");
+	if (file == NULL)
+	{
+		LOG_ERROR(LOG_CAT_APP, "Couldn't write startup timeline %s.", STARTUP_FILENAME);
+		return;
+	}
+
+	// Same format as the profiler trace: microseconds, one tid per thread.
+	frequency = SDL_GetPerformanceFrequency() / 1000000.0;
+	count = MIN(SDL_AtomicGet(&spanCount), STARTUP_MAX_SPANS);
+
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"main\"}}");
+
+	for (i = 1; i <= LOADER_MAX_THREADS; i++)
+	{
+		fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"loader %d\"}}", i, i);
+	}
+
+	for (i = 0; i < count; i++)
+	{
+		span = &spans[i];
+
+		if (!SDL_AtomicGet(&span->ready))
+		{
+			continue;
+		}
+
+		// A span still open here (the first frame itself) ends with the timeline.
+		fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+			span->name, span->thread, (span->start - origin) / frequency, (((span->end != 0) ? span->end : end) - span->start) / frequency);
+	}
+
+	fprintf(file, "\n]}\n");
+	fclose(file);
+}
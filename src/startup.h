@@ -0,0 +1,12 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+void initStartup(void);
+void startupBegin(const char *name);
+void startupEnd(void);
+void startupSpan(const char *name, int thread, Uint64 start, Uint64 end);
+void finishStartup(void);
+
+// Spans opened with startupBegin are main-thread only and must nest; startupSpan may be called from any thread.
+#define STARTUP_CALL(function) do { startupBegin(#function); function(); startupEnd(); } while (0)
@@ -2,25 +2,99 @@
 Copyright (C) 2023-2025 Asephri.net. All rights reserved.
 */
 
-typedef struct Entity Entity;
-typedef struct Explosion Explosion;
-typedef struct Debris Debris;
-typedef struct trail trail;
-typedef struct fire fire;
-typedef struct Texture Texture;
-
 typedef struct
 {
 	void(*logic)(void);
 	void(*draw)(void);
 } Delegate;
 
-struct Texture
+// A sprite's opaque pixels as drawn. x, y, w, h is the tight box around them, relative to the
+// sprite's top left corner; bit c of rows[r] is pixel (x + c, y + r). An empty sprite has w and h 0.
+typedef struct
+{
+	int x;
+	int y;
+	int w;
+	int h;
+	Uint64 rows[COLLISION_MASK_SIZE];
+} CollisionMask;
+
+typedef struct
 {
-	char name[MAX_NAME_LENGTH];
+	char *name;
+	Uint32 hash;
 	SDL_Texture *texture;
-	Texture *next;
-};
+	CollisionMask *mask;
+	int w;
+	int h;
+	Uint32 format;
+	Uint32 owners;
+	long bytes;
+	long saved;
+	long lastUsed;
+	int job;
+	int failed;
+} Texture;
+
+typedef struct
+{
+	double logic;
+	double draw;
+	double frame;
+} FrameTimes;
+
+typedef struct
+{
+	long drawCalls;
+	long stateChanges;
+	long redundantStates;
+	long textureSwitches;
+	long pixels;
+} RenderStats;
+
+typedef struct
+{
+	const char *name;
+	char *slab;
+	void *freeList;
+	int size;
+	int capacity;
+	int next;
+	int used;
+	int peak;
+	long exhausted;
+} Pool;
+
+typedef struct
+{
+	const char *name;
+	char *base;
+	size_t size;
+	size_t used;
+	size_t peak;
+	long overflows;
+} Arena;
+
+// Structure-of-arrays particle storage: one array per field, compacted by swap-remove.
+typedef struct
+{
+	const char *name;
+	int count;
+	int capacity;
+	int flags;
+	int metric;
+	float ax;
+	float ay;
+	float *x;
+	float *y;
+	float *dx;
+	float *dy;
+	int *life;
+	Uint32 *color;
+	SDL_Rect *src;
+	int *texture;
+	long dropped;
+} ParticleSystem;
 
 typedef struct
 {
@@ -28,83 +102,111 @@ typedef struct
 	SDL_Window *window;
 	Delegate delegate;
 	int keyboard[MAX_KEYBOARD_KEYS];
-	Texture textureHead, *textureTail;
 	char inputText[MAX_LINE_LENGTH];
+	FrameTimes frameTimes;
+	long frame;
+	int benchmark;
+	int scene;
 } App;
 
-struct Entity 
+typedef Uint32 EntityId;
+
+typedef struct
 {
 	float x;
 	float y;
 	int w;
 	int h;
-	float dx;
-	float dy;
-	int health;
-	int reload;
-	int side;
-	int alpha;
-	SDL_Texture *texture;
-	Entity *next;
-};
+} Transform;
 
-struct Explosion
+typedef struct
 {
-	float x;
-	float y;
 	float dx;
 	float dy;
-	int r, g, b, a;
-	Explosion *next;
-};
+} Velocity;
 
-struct Debris
+// One table per archetype: each component is a dense array indexed by row, NULL when the archetype lacks it.
+typedef struct
 {
-	float x;
-	float y;
-	float dx;
-	float dy;
-	SDL_Rect rect;
-	SDL_Texture *texture;
-	int life;
-	Debris *next;
-};
+	const char *name;
+	int components;
+	int count;
+	int capacity;
+	int metric;
+	EntityId *id;
+	Transform *transform;
+	Velocity *velocity;
+	int *sprite;
+	int *health;
+	int *reload;
+	int *side;
+	Uint32 *expires;
+	long dropped;
+} Archetype;
 
-struct trail
+// Boxes as separate min/max columns, so a kernel loads four or eight of each coordinate at once.
+typedef struct
 {
-	float x;
-	float y;
-	float dx;
-	float dy;
-	int r, g, b, a;
-	trail *next;
-};
+	float *minX;
+	float *minY;
+	float *maxX;
+	float *maxY;
+	int count;
+} AabbBatch;
 
-struct fire
+// Rows of one archetype bucketed by side and grid cell, rebuilt from scratch by buildGrid().
+// Each row sits in the cell holding its centre; queries widen by the largest half-size seen,
+// and sweeps also by the furthest any row moves in a tick. boxes holds every row's bounds in
+// bucket order, so a run of cells is one contiguous batch. times[k] is when in the tick a
+// sweep first touched found[k].
+typedef struct
 {
-	float        x;
-	float        y;
-	float        dx;
-	float        dy;
-	SDL_Rect     rect;
-	SDL_Texture *texture;
-	int          life;
-	fire      *next;
-};
+	const char *name;
+	const Archetype *archetype;
+	int start[GRID_BUCKETS + 1];
+	int *rows;
+	AabbBatch boxes;
+	int *found;
+	float *times;
+	int count;
+	int padW;
+	int padH;
+	float moveX;
+	float moveY;
+	long queries;
+	long candidates;
+} SpatialGrid;
 
+// One detected hit, waiting for the resolve pass. spot is the position quantised to the merge grid.
 typedef struct
 {
-	Entity fighterHead, *fighterTail;
-	Entity bulletHead, *bulletTail;
-	Explosion explosionHead, *explosionTail;
-	Debris debrisHead, *debrisTail;
-	trail trailHead, *trailTail;
-	fire fireHead, *fireTail;
-	Entity pointsHead, *pointsTail;
+	int kind;
+	Uint32 spot;
+	EntityId target;
+	float x;
+	float y;
+} Contact;
 
+typedef struct
+{
 	int score;
 } Stage;
 
+typedef void (*TimerCallback)(EntityId id);
+
+// Runs on a loader thread; returns the decoded asset, or NULL on failure.
+typedef void *(*LoadFunc)(const char *name);
+
+typedef struct Timer Timer;
+
+struct Timer
+{
+	Uint32 expires;
+	TimerCallback callback;
+	EntityId id;
+	Timer *next;
+};
+
 typedef struct
 {
 	int x;
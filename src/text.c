@@ -3,83 +3,64 @@ Copyright (C) 2023-2025 Asephri.net. All rights reserved.
 */
 
 #include "common.h"
+#include "arena.h"
 #include "draw.h"
+#include "texture.h"
+#include "render.h"
 #include "text.h"
 
-static SDL_Texture *fontTexture;
-static char drawTextBuffer[MAX_LINE_LENGTH];
-static int align;
+static int fontTexture;
+
+static void drawTextString(int x, int y, int r, int g, int b, int align, const char *text);
 
 void initFonts(void)
 {
-    fontTexture = loadTexture("gfx/font.png");
-    if (fontTexture == NULL)
+    fontTexture = loadTextureId("gfx/font.png", TEXTURE_SHARED);
+    if (fontTexture == 0)
     {
-        fprintf(stderr, "// SDL Error: Failed to load font texture: %s\n", SDL_GetError());
+        LOG_ERROR(LOG_CAT_RENDER, "Failed to load font texture: %s", SDL_GetError());
         exit(EXIT_FAILURE);
     }
-    printf("// Font initialized.\n");
+    LOG_INFO(LOG_CAT_RENDER, "Font initialized.");
 }
 
 void drawText(int x, int y, int r, int g, int b, char *format, ...)
 {
-    int i, len, c;
-    SDL_Rect rect;
     va_list args;
-
-    memset(&drawTextBuffer, '\0', sizeof(drawTextBuffer));
+    char *text;
 
     va_start(args, format);
-    vsprintf(drawTextBuffer, format, args);
+    text = frameFormatV(format, args);
     va_end(args);
 
-    len = strlen(drawTextBuffer);
-
-    switch (align)
-    {
-        case TEXT_RIGHT:
-            x -= (len * GLYPH_WIDTH);
-            break;
-
-        case TEXT_CENTER:
-            x -= (len * GLYPH_WIDTH) / 2;
-            break;
-    }
-
-    rect.w = GLYPH_WIDTH;
-    rect.h = GLYPH_HEIGHT;
-    rect.y = 0;
-
-    SDL_SetTextureColorMod(fontTexture, r, g, b);
-
-    for (i = 0; i < len; i++)
-    {
-        c = drawTextBuffer[i];
+    drawTextString(x, y, r, g, b, TEXT_LEFT, text);
+}
 
-        if (c >= ' ' && c <= 'Z')
-        {
-            rect.x = (c - ' ') * GLYPH_WIDTH;
+void drawTextPOSITION(int x, int y, int r, int g, int b, int align, char *format, ...)
+{
+    va_list args;
+    char *text;
 
-            blitRect(fontTexture, &rect, x, y);
+    va_start(args, format);
+    text = frameFormatV(format, args);
+    va_end(args);
 
-            x += GLYPH_WIDTH;
-        }
-    }
+    drawTextString(x, y, r, g, b, align, text);
 }
 
-void drawTextPOSITION(int x, int y, int r, int g, int b, int align, char *format, ...)
+static void drawTextString(int x, int y, int r, int g, int b, int align, const char *text)
 {
     int i, len, c;
     SDL_Rect rect;
-    va_list args;
-
-    memset(&drawTextBuffer, '\0', sizeof(drawTextBuffer));
+    SDL_Texture *font;
 
-    va_start(args, format);
-    vsprintf(drawTextBuffer, format, args);
-    va_end(args);
+    // The string lives in the frame arena; if that overflowed the text is simply skipped this frame.
+    if (text == NULL)
+    {
+        return;
+    }
 
-    len = strlen(drawTextBuffer);
+    len = strlen(text);
 
     switch (align)
     {
@@ -96,17 +77,19 @@ void drawTextPOSITION(int x, int y, int r, int g, int b, int align, char *format
     rect.h = GLYPH_HEIGHT;
     rect.y = 0;
 
-    SDL_SetTextureColorMod(fontTexture, r, g, b);
+    font = getTexture(fontTexture);
+
+    setTextureColor(font, r, g, b);
 
     for (i = 0; i < len; i++)
     {
-        c = drawTextBuffer[i];
+        c = text[i];
 
         if (c >= ' ' && c <= 'Z')
         {
             rect.x = (c - ' ') * GLYPH_WIDTH;
 
-            blitRect(fontTexture, &rect, x, y);
+            blitRect(font, &rect, x, y);
 
             x += GLYPH_WIDTH;
         }
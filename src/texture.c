@@ -0,0 +1,744 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+#include <SDL2/SDL_image.h>
+
+#include "common.h"
+#include "loader.h"
+#include "mask.h"
+#include "memtrack.h"
+#include "metrics.h"
+#include "packformat.h"
+#include "pack.h"
+#include "texture.h"
+#include "util.h"
+
+extern App app;
+
+// Full paths are interned into an open-addressed hash table that maps them to a slot in
+// textures[]. The slot index is the handle: resolve it once at init, then every lookup
+// during a frame is an array index. Handle 0 is never used, so it doubles as "no texture".
+//
+// Each scene (or TEXTURE_SHARED) that loads a texture holds a reference to it until
+// releaseTextures() drops the scene's references. Unreferenced textures stay resident as a
+// cache until the budget is exceeded, then go least recently drawn first. A handle stays
+// valid after eviction; getTexture() reloads it on demand.
+//
+// Decoded surfaces can be converted to a 16-bit storage format before upload, globally or per
+// texture. Each conversion is checked against the source and rejected if it loses too much.
+// Textures in the asset pack skip PNG decoding: the surface wraps the mapped pixels directly.
+//
+// Decoding and conversion run on the loader threads; only the upload happens here. A requested
+// texture has a handle at once and becomes resident when pumpTextures() or the first use picks
+// up the decoded surface.
+//
+// Sprites also get a collision mask at the size blit() draws them, from their first upload.
+// It lives in system memory, so it outlives eviction and hit tests never touch the renderer.
+
+typedef struct
+{
+	const char *name;
+	Uint32 format;
+} TextureFormatName;
+
+typedef struct
+{
+	char *path;
+	Uint32 format;
+} TextureFormatRule;
+
+static int parseFormat(const char *name, Uint32 *format);
+static void loadFormatRules(void);
+static Uint32 storageFormat(const char *name);
+static void *decodeTexture(const char *name);
+static SDL_Surface *packSurface(const char *name);
+static SDL_Surface *compactSurface(const char *name, SDL_Surface *surface, Uint32 format);
+static double comparePixels(SDL_Surface *source, SDL_Surface *compact);
+static void startTexture(int id);
+static int finishTexture(int id);
+static int uploadTexture(int id, SDL_Surface *surface);
+static void evictTexture(int id);
+static void trimTextures(int keep);
+static int countRefs(Uint32 owners);
+static Uint32 hashName(const char *name);
+static int findSlot(const char *name, Uint32 hash);
+
+static Texture textures[MAX_TEXTURES];
+static int table[TEXTURE_HASH_SIZE];
+static int numTextures = 1;
+static long residentBytes;
+static long budgetBytes = TEXTURE_BUDGET_MB * 1024L * 1024L;
+static long evictions;
+
+static const TextureFormatName formatNames[] = {
+	{"full", SDL_PIXELFORMAT_UNKNOWN},
+	{"rgb565", SDL_PIXELFORMAT_RGB565},
+	{"argb4444", SDL_PIXELFORMAT_ARGB4444},
+	{"argb1555", SDL_PIXELFORMAT_ARGB1555}
+};
+
+static Uint32 defaultFormat;
+static TextureFormatRule rules[MAX_TEXTURE_FORMAT_RULES];
+static int numRules;
+static long savedBytes;
+static SDL_atomic_t convertUs;
+static int packFormatChecked;
+
+void initTextures(int argc, char *argv[])
+{
+	const char *format;
+	int i;
+
+	format = TEXTURE_FORMAT;
+
+	for (i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--texture-budget") == 0 && i + 1 < argc)
+		{
+			budgetBytes = atol(argv[++i]) * 1024L * 1024L;
+		}
+		else if (strcmp(argv[i], "--texture-format") == 0 && i + 1 < argc)
+		{
+			format = argv[++i];
+		}
+	}
+
+	if (!parseFormat(format, &defaultFormat))
+	{
+		LOG_WARN(LOG_CAT_RENDER, "Unknown texture format '%s', using full.", format);
+		defaultFormat = SDL_PIXELFORMAT_UNKNOWN;
+	}
+
+	loadFormatRules();
+
+	if (budgetBytes > 0)
+	{
+		LOG_INFO(LOG_CAT_RENDER, "Texture budget: %ld MB.", budgetBytes / (1024L * 1024L));
+	}
+	else
+	{
+		LOG_INFO(LOG_CAT_RENDER, "Texture budget: unlimited.");
+	}
+
+	LOG_INFO(LOG_CAT_RENDER, "Texture format: %s, %d per-texture overrides.", format, numRules);
+}
+
+int requestTexture(const char *filename, int owner)
+{
+	Texture *texture;
+	Uint32 hash;
+	int slot, id;
+
+	METRIC_ADD(METRIC_TEXTURE_LOOKUPS, 1);
+
+	hash = hashName(filename);
+	slot = findSlot(filename, hash);
+
+	if (table[slot] != 0)
+	{
+		id = table[slot];
+		textures[id].owners |= 1U << owner;
+
+		// Evicted while nobody held it; the new owner wants it resident again.
+		startTexture(id);
+
+		return id;
+	}
+
+	if (numTextures >= MAX_TEXTURES)
+	{
+		LOG_ERROR(LOG_CAT_RENDER, "Texture registry full (%d), can't load %s.", MAX_TEXTURES, filename);
+		return 0;
+	}
+
+	id = numTextures;
+	texture = &textures[id];
+	memset(texture, 0, sizeof(Texture));
+
+	texture->name = memAlloc(strlen(filename) + 1, MEM_TAG_TEXTURES);
+	strcpy(texture->name, filename);
+	texture->hash = hash;
+	texture->owners = 1U << owner;
+
+	table[slot] = id;
+	numTextures++;
+
+	LOG_INFO(LOG_CAT_RENDER, "Texture '%s' registered as %d.", filename, id);
+
+	startTexture(id);
+
+	return id;
+}
+
+int loadTextureId(const char *filename, int owner)
+{
+	int id;
+
+	id = requestTexture(filename, owner);
+
+	if (id == 0 || !finishTexture(id))
+	{
+		return 0;
+	}
+
+	return id;
+}
+
+SDL_Texture *getTexture(int id)
+{
+	Texture *texture;
+
+	texture = &textures[id];
+
+	if (texture->texture == NULL && texture->name != NULL && !texture->failed)
+	{
+		if (texture->job != 0)
+		{
+			LOG_WARN(LOG_CAT_RENDER, "Texture '%s' drawn before its load finished, waiting.", texture->name);
+		}
+		else
+		{
+			LOG_WARN(LOG_CAT_RENDER, "Texture '%s' drawn after eviction, reloading.", texture->name);
+		}
+
+		finishTexture(id);
+	}
+
+	texture->lastUsed = app.frame;
+
+	return texture->texture;
+}
+
+void getTextureSize(int id, int *w, int *h)
+{
+	// The size is only known once the image is decoded.
+	if (textures[id].texture == NULL)
+	{
+		finishTexture(id);
+	}
+
+	*w = textures[id].w;
+	*h = textures[id].h;
+}
+
+// NULL for textures bigger than a sprite, and until the texture is first uploaded;
+// getTextureSize() at spawn has already seen to that for anything on screen.
+const CollisionMask *getCollisionMask(int id)
+{
+	return textures[id].mask;
+}
+
+void pumpTextures(void)
+{
+	int i, uploads;
+
+	uploads = 0;
+
+	// Uploads are capped per frame so a burst of finished decodes can't become a hitch of its own.
+	for (i = 1; i < numTextures && uploads < LOADER_UPLOADS_PER_FRAME; i++)
+	{
+		if (textures[i].job != 0 && loadDone(textures[i].job))
+		{
+			finishTexture(i);
+			uploads++;
+		}
+	}
+}
+
+void finishTextures(int owner)
+{
+	int i;
+
+	for (i = 1; i < numTextures; i++)
+	{
+		if (textures[i].owners & (1U << owner))
+		{
+			finishTexture(i);
+		}
+	}
+}
+
+void releaseTextures(int owner)
+{
+	int i, released;
+
+	released = 0;
+
+	for (i = 1; i < numTextures; i++)
+	{
+		if (textures[i].owners & (1U << owner))
+		{
+			textures[i].owners &= ~(1U << owner);
+			released++;
+		}
+	}
+
+	trimTextures(0);
+
+	LOG_INFO(LOG_CAT_RENDER, "Released %d textures of owner %d; %ld KB resident.", released, owner, residentBytes / 1024);
+}
+
+void reportTextures(const char *when)
+{
+	Texture *texture;
+	int i;
+
+	LOG_INFO(LOG_CAT_RENDER, "Textures %s: %ld bytes resident, budget %ld bytes, %ld evictions.", when, residentBytes, budgetBytes, evictions);
+	LOG_INFO(LOG_CAT_RENDER, "Compact formats save %ld bytes of resident textures; %.2f ms spent converting.", savedBytes, SDL_AtomicGet(&convertUs) / 1000.0);
+
+	for (i = 1; i < numTextures; i++)
+	{
+		texture = &textures[i];
+
+		LOG_INFO(LOG_CAT_RENDER, "  %-32s %4dx%-4d %-20s %9ld bytes %-9s refs %d, last drawn frame %ld",
+			texture->name, texture->w, texture->h, SDL_GetPixelFormatName(texture->format), (texture->texture != NULL) ? texture->bytes : 0L,
+			(texture->texture != NULL) ? "resident" : texture->failed ? "failed" : (texture->job != 0) ? "loading" : "evicted",
+			countRefs(texture->owners), texture->lastUsed);
+	}
+}
+
+void destroyTextures(void)
+{
+	int i;
+
+	reportTextures("at exit");
+
+	for (i = 1; i < numTextures; i++)
+	{
+		// Never drawn, still in flight: collect the surface so the loader can shut down clean.
+		if (textures[i].job != 0)
+		{
+			SDL_FreeSurface(waitLoad(textures[i].job));
+		}
+
+		if (textures[i].texture != NULL)
+		{
+			MEM_SCOPE(MEM_TAG_TEXTURES, SDL_DestroyTexture(textures[i].texture));
+		}
+
+		memFree(textures[i].mask);
+		memFree(textures[i].name);
+	}
+
+	for (i = 0; i < numRules; i++)
+	{
+		memFree(rules[i].path);
+	}
+
+	memset(textures, 0, sizeof(textures));
+	memset(table, 0, sizeof(table));
+	numTextures = 1;
+	numRules = 0;
+	residentBytes = 0;
+	savedBytes = 0;
+
+	METRIC_SET(METRIC_TEXTURE_BYTES, 0);
+
+	LOG_INFO(LOG_CAT_RENDER, "Texture registry released.");
+}
+
+static void *decodeTexture(const char *name)
+{
+	SDL_Surface *surface;
+	Uint32 format;
+
+	LOG_INFO(LOG_CAT_RENDER, "Loading %s", name);
+
+	surface = packSurface(name);
+
+	if (surface == NULL)
+	{
+		MEM_SCOPE(MEM_TAG_TEXTURES, surface = IMG_Load(name));
+	}
+
+	if (surface == NULL)
+	{
+		LOG_ERROR(LOG_CAT_RENDER, "Failed to load texture %s: %s", name, SDL_GetError());
+		return NULL;
+	}
+
+	format = storageFormat(name);
+
+	if (format != SDL_PIXELFORMAT_UNKNOWN && format != surface->format->format)
+	{
+		surface = compactSurface(name, surface, format);
+	}
+
+	return surface;
+}
+
+static void startTexture(int id)
+{
+	Texture *texture;
+
+	texture = &textures[id];
+
+	if (texture->name == NULL || texture->texture != NULL || texture->job != 0 || texture->failed)
+	{
+		return;
+	}
+
+	METRIC_ADD(METRIC_TEXTURE_MISSES, 1);
+
+	texture->job = queueLoad(decodeTexture, texture->name);
+
+	if (texture->job == 0)
+	{
+		uploadTexture(id, decodeTexture(texture->name));
+	}
+}
+
+static int finishTexture(int id)
+{
+	Texture *texture;
+	SDL_Surface *surface;
+
+	texture = &textures[id];
+
+	startTexture(id);
+
+	if (texture->job != 0)
+	{
+		surface = waitLoad(texture->job);
+		texture->job = 0;
+
+		uploadTexture(id, surface);
+	}
+
+	return texture->texture != NULL;
+}
+
+static int uploadTexture(int id, SDL_Surface *surface)
+{
+	Texture *texture;
+	Uint32 format;
+	int packed;
+
+	texture = &textures[id];
+
+	if (surface == NULL)
+	{
+		texture->failed = 1;
+		return 0;
+	}
+
+	format = surface->format->format;
+	packed = (surface->flags & SDL_PREALLOC) != 0;
+
+	if (texture->mask == NULL && surface->w <= SPRITE_DRAW_SIZE && surface->h <= SPRITE_DRAW_SIZE)
+	{
+		texture->mask = buildCollisionMask(surface, SPRITE_DRAW_SIZE, SPRITE_DRAW_SIZE);
+
+		if (texture->mask != NULL)
+		{
+			LOG_DEBUG(LOG_CAT_RENDER, "Texture '%s' hitbox %dx%d at %d,%d as drawn.", texture->name, texture->mask->w, texture->mask->h, texture->mask->x, texture->mask->y);
+		}
+	}
+
+	MEM_SCOPE(MEM_TAG_TEXTURES, texture->texture = SDL_CreateTextureFromSurface(app.renderer, surface));
+	SDL_FreeSurface(surface);
+	if (texture->texture == NULL)
+	{
+		LOG_ERROR(LOG_CAT_RENDER, "Failed to create texture %s: %s", texture->name, SDL_GetError());
+		texture->failed = 1;
+		return 0;
+	}
+
+	SDL_QueryTexture(texture->texture, &texture->format, NULL, &texture->w, &texture->h);
+	texture->bytes = (long)texture->w * texture->h * SDL_BYTESPERPIXEL(texture->format);
+	texture->lastUsed = app.frame;
+
+	// Savings are against the 32 bits per pixel every texture was uploaded at before.
+	texture->saved = (long)texture->w * texture->h * 4 - texture->bytes;
+
+	if (SDL_BYTESPERPIXEL(format) < 4 && texture->format != format)
+	{
+		LOG_WARN(LOG_CAT_RENDER, "Renderer stores '%s' as %s instead of %s.", texture->name, SDL_GetPixelFormatName(texture->format), SDL_GetPixelFormatName(format));
+	}
+	else if (packed && texture->format != format && !packFormatChecked)
+	{
+		// Pack surfaces wrap the mapped pixels; converting them on upload means the pack was baked for another renderer.
+		LOG_WARN(LOG_CAT_RENDER, "Asset pack pixels are %s but the renderer stores %s, so every upload converts; rebake it.", SDL_GetPixelFormatName(format), SDL_GetPixelFormatName(texture->format));
+		packFormatChecked = 1;
+	}
+
+	residentBytes += texture->bytes;
+	savedBytes += texture->saved;
+
+	trimTextures(id);
+
+	METRIC_SET(METRIC_TEXTURE_BYTES, residentBytes);
+
+	LOG_INFO(LOG_CAT_RENDER, "Texture '%s' uploaded as %d (%dx%d, %s, %ld bytes).", texture->name, id, texture->w, texture->h, SDL_GetPixelFormatName(texture->format), texture->bytes);
+
+	return 1;
+}
+
+static void evictTexture(int id)
+{
+	Texture *texture;
+
+	texture = &textures[id];
+
+	LOG_INFO(LOG_CAT_RENDER, "Evicting texture '%s' (%ld bytes, last drawn frame %ld).", texture->name, texture->bytes, texture->lastUsed);
+
+	MEM_SCOPE(MEM_TAG_TEXTURES, SDL_DestroyTexture(texture->texture));
+	texture->texture = NULL;
+
+	residentBytes -= texture->bytes;
+	savedBytes -= texture->saved;
+	evictions++;
+
+	METRIC_ADD(METRIC_TEXTURE_EVICTIONS, 1);
+	METRIC_SET(METRIC_TEXTURE_BYTES, residentBytes);
+}
+
+static void trimTextures(int keep)
+{
+	int i, lru;
+
+	while (budgetBytes > 0 && residentBytes > budgetBytes)
+	{
+		lru = 0;
+
+		// Eviction only happens on loads and scene changes, so a scan of the registry is fine.
+		for (i = 1; i < numTextures; i++)
+		{
+			if (i != keep && textures[i].texture != NULL && textures[i].owners == 0 &&
+				(lru == 0 || textures[i].lastUsed < textures[lru].lastUsed))
+			{
+				lru = i;
+			}
+		}
+
+		if (lru == 0)
+		{
+			LOG_WARN(LOG_CAT_RENDER, "Texture budget exceeded: %ld of %ld bytes resident and all of it referenced.", residentBytes, budgetBytes);
+			return;
+		}
+
+		evictTexture(lru);
+	}
+}
+
+static int parseFormat(const char *name, Uint32 *format)
+{
+	int i;
+
+	for (i = 0; i < (int)(sizeof(formatNames) / sizeof(formatNames[0])); i++)
+	{
+		if (strcmp(name, formatNames[i].name) == 0)
+		{
+			*format = formatNames[i].format;
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+static void loadFormatRules(void)
+{
+	FILE *file;
+	char path[MAX_LINE_LENGTH], name[MAX_LINE_LENGTH];
+	Uint32 format;
+
+	// Optional; without it every texture uses the global format.
+	file = fopen(TEXTURE_FORMATS_FILENAME, "r");
+	if (file == NULL)
+	{
+		return;
+	}
+
+	while (numRules < MAX_TEXTURE_FORMAT_RULES && fscanf(file, "%1023s %1023s", path, name) == 2)
+	{
+		if (!parseFormat(name, &format))
+		{
+			LOG_WARN(LOG_CAT_RENDER, "%s: unknown format '%s' for %s.", TEXTURE_FORMATS_FILENAME, name, path);
+			continue;
+		}
+
+		rules[numRules].path = memAlloc(strlen(path) + 1, MEM_TAG_TEXTURES);
+		strcpy(rules[numRules].path, path);
+		rules[numRules].format = format;
+		numRules++;
+	}
+
+	fclose(file);
+}
+
+static Uint32 storageFormat(const char *name)
+{
+	int i;
+
+	for (i = 0; i < numRules; i++)
+	{
+		if (strcmp(rules[i].path, name) == 0)
+		{
+			return rules[i].format;
+		}
+	}
+
+	return defaultFormat;
+}
+
+static SDL_Surface *packSurface(const char *name)
+{
+	const PackEntry *entry;
+
+	entry = findPackEntry(name, PACK_IMAGE);
+	if (entry == NULL)
+	{
+		return NULL;
+	}
+
+	// Surfaces made from existing pixels never free them, so this is safe to hand to SDL_FreeSurface later.
+	return SDL_CreateRGBSurfaceWithFormatFrom((void *)packData(entry), entry->w, entry->h, SDL_BITSPERPIXEL(entry->format), entry->pitch, entry->format);
+}
+
+static SDL_Surface *compactSurface(const char *name, SDL_Surface *surface, Uint32 format)
+{
+	SDL_Surface *compact;
+	Uint64 start;
+	double psnr, ms;
+
+	start = SDL_GetPerformanceCounter();
+
+	MEM_SCOPE(MEM_TAG_TEXTURES, compact = SDL_ConvertSurfaceFormat(surface, format, 0));
+	if (compact == NULL)
+	{
+		LOG_WARN(LOG_CAT_RENDER, "Couldn't convert '%s' to %s: %s", name, SDL_GetPixelFormatName(format), SDL_GetError());
+		return surface;
+	}
+
+	psnr = comparePixels(surface, compact);
+
+	ms = ticksToMs(SDL_GetPerformanceCounter() - start);
+	SDL_AtomicAdd(&convertUs, (int)(ms * 1000));
+
+	if (psnr < TEXTURE_PSNR_MIN)
+	{
+		LOG_WARN(LOG_CAT_RENDER, "Texture '%s' loses too much as %s (PSNR %.1f dB, minimum %.1f); keeping %s.", name, SDL_GetPixelFormatName(format), psnr, TEXTURE_PSNR_MIN, SDL_GetPixelFormatName(surface->format->format));
+		SDL_FreeSurface(compact);
+		return surface;
+	}
+
+	LOG_INFO(LOG_CAT_RENDER, "Texture '%s' converted to %s in %.2f ms (PSNR %.1f dB).", name, SDL_GetPixelFormatName(format), ms, psnr);
+
+	SDL_FreeSurface(surface);
+
+	return compact;
+}
+
+static double comparePixels(SDL_Surface *source, SDL_Surface *compact)
+{
+	SDL_Surface *a, *b;
+	Uint32 *rowA, *rowB;
+	double error, samples;
+	int x, y, c, d;
+
+	// Both sides are expanded back to 8 bits per channel so the difference is what the screen would show.
+	a = SDL_ConvertSurfaceFormat(source, SDL_PIXELFORMAT_ARGB8888, 0);
+	b = SDL_ConvertSurfaceFormat(compact, SDL_PIXELFORMAT_ARGB8888, 0);
+
+	if (a == NULL || b == NULL)
+	{
+		SDL_FreeSurface(a);
+		SDL_FreeSurface(b);
+		return 0;
+	}
+
+	SDL_LockSurface(a);
+	SDL_LockSurface(b);
+
+	error = 0;
+	samples = 0;
+
+	for (y = 0; y < a->h; y++)
+	{
+		rowA = (Uint32 *)((Uint8 *)a->pixels + y * a->pitch);
+		rowB = (Uint32 *)((Uint8 *)b->pixels + y * b->pitch);
+
+		for (x = 0; x < a->w; x++)
+		{
+			// Transparent on both sides: whatever colour is underneath never reaches the screen.
+			if ((rowA[x] >> 24) == 0 && (rowB[x] >> 24) == 0)
+			{
+				continue;
+			}
+
+			for (c = 0; c < 32; c += 8)
+			{
+				d = (int)((rowA[x] >> c) & 0xff) - (int)((rowB[x] >> c) & 0xff);
+				error += d * d;
+			}
+
+			samples += 4;
+		}
+	}
+
+	SDL_UnlockSurface(a);
+	SDL_UnlockSurface(b);
+	SDL_FreeSurface(a);
+	SDL_FreeSurface(b);
+
+	// Identical, or nothing visible to compare; report a ceiling rather than infinity.
+	if (error == 0)
+	{
+		return 99.0;
+	}
+
+	return 10.0 * log10(255.0 * 255.0 * samples / error);
+}
+
+static int countRefs(Uint32 owners)
+{
+	int refs;
+
+	for (refs = 0; owners != 0; owners &= owners - 1)
+	{
+		refs++;
+	}
+
+	return refs;
+}
+
+static Uint32 hashName(const char *name)
+{
+	Uint32 hash;
+
+	// FNV-1a.
+	hash = 2166136261U;
+
+	while (*name != '\0')
+	{
+		hash ^= (unsigned char)*name++;
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+static int findSlot(const char *name, Uint32 hash)
+{
+	Texture *texture;
+	int slot;
+
+	// Linear probing; the table is at least twice MAX_TEXTURES, so there is always an empty slot.
+	slot = hash & (TEXTURE_HASH_SIZE - 1);
+
+	while (table[slot] != 0)
+	{
+		texture = &textures[table[slot]];
+
+		if (texture->hash == hash && strcmp(texture->name, name) == 0)
+		{
+			break;
+		}
+
+		slot = (slot + 1) & (TEXTURE_HASH_SIZE - 1);
+	}
+
+	return slot;
+}
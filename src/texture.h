@@ -0,0 +1,15 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+void initTextures(int argc, char *argv[]);
+int requestTexture(const char *filename, int owner);
+int loadTextureId(const char *filename, int owner);
+SDL_Texture *getTexture(int id);
+void getTextureSize(int id, int *w, int *h);
+const CollisionMask *getCollisionMask(int id);
+void pumpTextures(void);
+void finishTextures(int owner);
+void releaseTextures(int owner);
+void reportTextures(const char *when);
+void destroyTextures(void);
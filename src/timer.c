@@ -0,0 +1,155 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+#include "common.h"
+#include "metrics.h"
+#include "pool.h"
+#include "timer.h"
+
+// Hierarchical timing wheel. Level 0 holds timers due within TIMER_WHEEL_SLOTS ticks, one slot per
+// tick; each higher level covers TIMER_WHEEL_SLOTS times the span of the one below. When a lower
+// wheel wraps, the matching slot of the next level is redistributed, so a timer is touched once per
+// level it crosses and once when it fires, never once per frame while it waits.
+
+#define TIMER_SLOT_MASK (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_MAX_DELAY ((1U << (TIMER_WHEEL_BITS * TIMER_LEVELS)) - 1)
+
+static void insertTimer(Timer *timer);
+static void cascade(int level);
+
+static Timer *wheel[TIMER_LEVELS][TIMER_WHEEL_SLOTS];
+static Pool timerPool;
+static Uint32 now;
+static int epoch;
+
+void initTimers(void)
+{
+	initPool(&timerPool, "timers", sizeof(Timer), POOL_TIMERS);
+
+	memset(wheel, 0, sizeof(wheel));
+	now = 0;
+}
+
+void shutdownTimers(void)
+{
+	destroyPool(&timerPool);
+
+	memset(wheel, 0, sizeof(wheel));
+}
+
+int scheduleTimer(Uint32 delay, TimerCallback callback, EntityId id)
+{
+	Timer *timer;
+
+	timer = poolAlloc(&timerPool);
+	if (timer == NULL)
+	{
+		return 0;
+	}
+
+	timer->expires = now + MIN(MAX(delay, 1), TIMER_MAX_DELAY);
+	timer->callback = callback;
+	timer->id = id;
+
+	insertTimer(timer);
+
+	METRIC_SET(METRIC_TIMERS, timerPool.used);
+
+	return 1;
+}
+
+void clearTimers(void)
+{
+	// Scene changes drop everything at once; advanceTimers() notices the new epoch and stops.
+	poolReset(&timerPool);
+	memset(wheel, 0, sizeof(wheel));
+	epoch++;
+
+	METRIC_SET(METRIC_TIMERS, 0);
+}
+
+void advanceTimers(void)
+{
+	Timer *timer, *next;
+	TimerCallback callback;
+	EntityId id;
+	int level, current;
+
+	now++;
+
+	for (level = 1; level < TIMER_LEVELS && ((now >> (TIMER_WHEEL_BITS * (level - 1))) & TIMER_SLOT_MASK) == 0; level++)
+	{
+		cascade(level);
+	}
+
+	timer = wheel[0][now & TIMER_SLOT_MASK];
+	wheel[0][now & TIMER_SLOT_MASK] = NULL;
+
+	current = epoch;
+
+	while (timer != NULL)
+	{
+		next = timer->next;
+		callback = timer->callback;
+		id = timer->id;
+
+		poolFree(&timerPool, timer);
+		METRIC_ADD(METRIC_TIMERS_FIRED, 1);
+
+		callback(id);
+
+		// The callback changed scene and cleared the wheel; the rest of this list is gone with it.
+		if (epoch != current)
+		{
+			return;
+		}
+
+		timer = next;
+	}
+
+	METRIC_SET(METRIC_TIMERS, timerPool.used);
+}
+
+Uint32 getTimerTick(void)
+{
+	return now;
+}
+
+static void insertTimer(Timer *timer)
+{
+	Uint32 delta;
+	int level, slot;
+
+	delta = timer->expires - now;
+	level = 0;
+
+	while (level < TIMER_LEVELS - 1 && delta >= (1U << (TIMER_WHEEL_BITS * (level + 1))))
+	{
+		level++;
+	}
+
+	slot = (timer->expires >> (TIMER_WHEEL_BITS * level)) & TIMER_SLOT_MASK;
+
+	timer->next = wheel[level][slot];
+	wheel[level][slot] = timer;
+}
+
+static void cascade(int level)
+{
+	Timer *timer, *next;
+	int slot;
+
+	slot = (now >> (TIMER_WHEEL_BITS * level)) & TIMER_SLOT_MASK;
+
+	timer = wheel[level][slot];
+	wheel[level][slot] = NULL;
+
+	// Everything here is now due within this level's span below, so it lands on a lower wheel.
+	while (timer != NULL)
+	{
+		next = timer->next;
+		insertTimer(timer);
+		timer = next;
+	}
+}
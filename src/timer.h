@@ -0,0 +1,10 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+void initTimers(void);
+void shutdownTimers(void);
+int scheduleTimer(Uint32 delay, TimerCallback callback, EntityId id);
+void clearTimers(void);
+void advanceTimers(void);
+Uint32 getTimerTick(void);
@@ -9,6 +9,8 @@ Copyright (C) 2023-2025 Asephri.net. All rights reserved.
 #include "highscores.h"
 #include "stage.h"
 #include "text.h"
+#include "texture.h"
+#include "timer.h"
 #include "title.h"
 
 extern App app;
@@ -16,23 +18,58 @@ extern App app;
 static void logic(void);
 static void draw(void);
 static void drawTitle(void);
+static void timeoutTitle(EntityId id);
+static void requestTitleTextures(void);
 
-static SDL_Texture *voidfighter_titleTexture;
+static int voidfighter_titleTexture;
 static int reveal = 0;
-static int timeout;
+static Uint32 timeout;
 
 void initTitle(void)
 {
-    printf("Initialising title.\n");
+    int previous;
+
+    LOG_INFO(LOG_CAT_APP, "Initialising title.");
+
+    previous = app.scene;
 
     app.delegate.logic = logic;
     app.delegate.draw = draw;
+    app.scene = SCENE_TITLE;
 
     memset(app.keyboard, 0, sizeof(int) * MAX_KEYBOARD_KEYS);
 
-    voidfighter_titleTexture = loadTexture("gfx/voidfighter_title.png");
+    requestTitleTextures();
+
+    // Prefetched at startup and from the highscore table; whatever is still decoding is waited for here.
+    finishTextures(SCENE_TITLE);
+
+    if (previous != app.scene)
+    {
+        releaseTextures(previous);
+    }
+
+    // The stage or, on timeout, the highscore table is next; their textures decode while the title is up.
+    prefetchStage();
+    prefetchHighscores();
+
+    // The prompt blinks against the tick this countdown reaches zero; the scene changes TITLE_TIMEOUT_GRACE ticks later.
+    clearTimers();
+    timeout = getTimerTick() + TITLE_TIMEOUT;
+    scheduleTimer(TITLE_TIMEOUT + TITLE_TIMEOUT_GRACE, timeoutTitle, ENTITY_NONE);
+}
+
+// Starts decoding the title's textures in the background so initTitle() finds them ready.
+void prefetchTitle(void)
+{
+    requestTitleTextures();
+}
 
-    timeout = FPS * 5;
+static void requestTitleTextures(void)
+{
+    voidfighter_titleTexture = requestTexture("gfx/voidfighter_title.png", SCENE_TITLE);
+
+    requestHud(SCENE_TITLE);
 }
 
 static void logic(void)
@@ -48,11 +85,6 @@ static void logic(void)
         reveal++;
     }
 
-    if (--timeout <= -80)
-    {
-        initHighscores(); 
-    }
-
     if (app.keyboard[SDL_SCANCODE_LCTRL])
     {
         initStage();
@@ -70,7 +102,7 @@ static void draw(void)
 
     drawTitle();
 
-    if (timeout % 40 < 20)
+    if ((int)(timeout - getTimerTick()) % 40 < 20)
     {
         drawTextPOSITION(SCREEN_WIDTH / 2, 600, 255,255,255, TEXT_CENTER, "PRESS RCTRL TO PLAY!");
     }
@@ -84,9 +116,14 @@ static void drawTitle(void)
     r.x = 0;
     r.y = 0;
 
-    SDL_QueryTexture(voidfighter_titleTexture, NULL, NULL, &r.w, &r.h);
+    getTextureSize(voidfighter_titleTexture, &r.w, &r.h);
 
     r.h = MIN(reveal, r.h);
 
-    blitRect(voidfighter_titleTexture, &r, (SCREEN_WIDTH / 2) - (r.w / 2), 100);
+    blitRect(getTexture(voidfighter_titleTexture), &r, (SCREEN_WIDTH / 2) - (r.w / 2), 100);
+}
+
+static void timeoutTitle(EntityId id)
+{
+    initHighscores();
 }
\ No newline at end of file
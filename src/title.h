@@ -2,4 +2,5 @@
 Copyright (C) 2023-2025 Asephri.net. All rights reserved.
 */
 
-void initTitle(void);
\ No newline at end of file
+void initTitle(void);
+void prefetchTitle(void);
\ No newline at end of file
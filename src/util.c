@@ -5,21 +5,7 @@ Copyright (C) 2023-2025 Asephri.net. All rights reserved.
 #include "common.h"
 #include "util.h"
 
-int collision(int x1, int y1, int w1, int h1, int x2, int y2, int w2, int h2)
-{
-	int result = (MAX(x1, x2) < MIN(x1 + w1, x2 + w2)) && (MAX(y1, y2) < MIN(y1 + h1, y2 + h2));
-
-	if (result)
-	{
-		printf("Collision detected!\n");
-	}
-	else
-	{
-		printf("No collision.\n");
-	}
-
-	return result;
-}
+extern App app;
 
 void calcSlope(int x1, int y1, int x2, int y2, float *dx, float *dy)
 {
@@ -28,7 +14,7 @@ void calcSlope(int x1, int y1, int x2, int y2, float *dx, float *dy)
 	if (steps == 0)
 	{
 		*dx = *dy = 0;
-		printf("Both points are the same. No slope calculation needed.\n");
+		LOG_TRACE(LOG_CAT_COLLISION, "Both points are the same. No slope calculation needed.");
 		return;
 	}
 
@@ -38,5 +24,28 @@ void calcSlope(int x1, int y1, int x2, int y2, float *dx, float *dy)
 	*dy = (y1 - y2);
 	*dy /= steps;
 
-	printf("Slope calculated: dx = %f, dy = %f\n", *dx, *dy);
-}
\ No newline at end of file
+	LOG_TRACE(LOG_CAT_COLLISION, "Slope calculated: dx = %f, dy = %f", *dx, *dy);
+}
+
+double ticksToMs(Uint64 ticks)
+{
+	return (double)ticks * 1000.0 / SDL_GetPerformanceFrequency();
+}
+
+Uint32 getGameTicks(void)
+{
+	// Benchmarks run unthrottled, so derive time from the frame count to keep runs repeatable.
+	if (app.benchmark)
+	{
+		return app.frame * 1000 / FPS;
+	}
+
+	return SDL_GetTicks();
+}
+
+// Callers that count a repeated failure warn on the 1st, 2nd, 4th, 8th... so the log shows how
+// often it happens without a line per miss.
+int shouldWarn(long count)
+{
+	return count > 0 && (count & (count - 1)) == 0;
+}
@@ -2,5 +2,7 @@
 Copyright (C) 2023-2025 Asephri.net. All rights reserved.
 */
 
-int collision(int x1, int y1, int w1, int h1, int x2, int y2, int w2, int h2);
-void calcSlope(int x1, int y1, int x2, int y2, float *dx, float *dy);
\ No newline at end of file
+void calcSlope(int x1, int y1, int x2, int y2, float *dx, float *dy);
+double ticksToMs(Uint64 ticks);
+Uint32 getGameTicks(void);
+int shouldWarn(long count);
@@ -0,0 +1,397 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+// Checks and times the batch collision kernels in src/aabb.c.
+// Every kernel the CPU supports is first compared against the integer predicate the game used
+// before the batch API, exhaustively over small boxes, then against the scalar kernel on random
+// float boxes, NaNs and infinities included. Then each is timed in nanoseconds per pair over a
+// range of batch sizes: a grid run is usually a handful of boxes, a brute-force walk is thousands.
+// sweepAabb() is checked once against the overlap test stepped finely through the tick.
+// Usage: aabbbench [pairs per measurement, default 20000000]
+// Exits 1 if any kernel disagrees.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL2/SDL.h>
+
+#include "../src/defs.h"
+#include "../src/structs.h"
+#include "../src/aabb.h"
+
+#define SMALL_MIN -3
+#define SMALL_MAX 3
+#define SMALL_SIZE_MIN -1
+#define SMALL_SIZE_MAX 3
+#define SMALL_SPAN (SMALL_MAX - SMALL_MIN + 1)
+#define SMALL_SIZES (SMALL_SIZE_MAX - SMALL_SIZE_MIN + 1)
+#define SMALL_AXIS (SMALL_SPAN * SMALL_SIZES)
+#define SMALL_BOXES (SMALL_AXIS * SMALL_AXIS)
+#define RANDOM_BOXES 4096
+#define RANDOM_QUERIES 2048
+#define SWEEPS 100000
+#define SWEEP_STEPS 4096
+
+typedef struct
+{
+	int x;
+	int y;
+	int w;
+	int h;
+} Box;
+
+static int batchSizes[] = {4, 8, 16, 64, 256, 4096};
+
+static AabbBatch batch;
+static int *hits;
+static char *expected;
+
+// The game's collision() before the batch kernels, minus its logging and metrics.
+static int reference(int x1, int y1, int w1, int h1, int x2, int y2, int w2, int h2)
+{
+	return (MAX(x1, x2) < MIN(x1 + w1, x2 + w2)) && (MAX(y1, y2) < MIN(y1 + h1, y2 + h2));
+}
+
+static void allocBatch(int count)
+{
+	batch.minX = malloc(sizeof(float) * count);
+	batch.minY = malloc(sizeof(float) * count);
+	batch.maxX = malloc(sizeof(float) * count);
+	batch.maxY = malloc(sizeof(float) * count);
+	hits = malloc(sizeof(int) * count);
+	expected = malloc(count);
+
+	if (batch.minX == NULL || batch.minY == NULL || batch.maxX == NULL || batch.maxY == NULL || hits == NULL || expected == NULL)
+	{
+		fprintf(stderr, "out of memory\n");
+		exit(1);
+	}
+}
+
+static Box smallBox(int index)
+{
+	Box box;
+	int x, y;
+
+	x = index % SMALL_AXIS;
+	y = index / SMALL_AXIS;
+
+	box.x = SMALL_MIN + x % SMALL_SPAN;
+	box.w = SMALL_SIZE_MIN + x / SMALL_SPAN;
+	box.y = SMALL_MIN + y % SMALL_SPAN;
+	box.h = SMALL_SIZE_MIN + y / SMALL_SPAN;
+
+	return box;
+}
+
+static float randomCoordinate(void)
+{
+	switch (rand() % 64)
+	{
+		case 0:
+			return NAN;
+
+		case 1:
+			return INFINITY;
+
+		case 2:
+			return -INFINITY;
+
+		default:
+			// Coarse steps make exact touching edges common.
+			return (rand() % 2048 - 1024) * 0.25f;
+	}
+}
+
+// Compares the listed hits of batch[from, from + count) with expected[], which is indexed from 0.
+static int matches(int from, int count, int n)
+{
+	int i, j;
+
+	for (i = 0, j = 0; i < count; i++)
+	{
+		if (expected[from + i] != (j < n && hits[j] == i))
+		{
+			return 0;
+		}
+
+		if (j < n && hits[j] == i)
+		{
+			j++;
+		}
+	}
+
+	return j == n;
+}
+
+static int runBatch(int from, int count, const float *query)
+{
+	AabbBatch view;
+
+	view.minX = batch.minX + from;
+	view.minY = batch.minY + from;
+	view.maxX = batch.maxX + from;
+	view.maxY = batch.maxY + from;
+	view.count = count;
+
+	return overlapAabbs(&view, query, hits);
+}
+
+static long checkSmall(void)
+{
+	Box q, b;
+	float query[4];
+	int i, k, from, count;
+	long failures;
+
+	for (i = 0; i < SMALL_BOXES; i++)
+	{
+		b = smallBox(i);
+		batch.minX[i] = b.x;
+		batch.minY[i] = b.y;
+		batch.maxX[i] = b.x + b.w;
+		batch.maxY[i] = b.y + b.h;
+	}
+
+	failures = 0;
+
+	for (k = 0; k < SMALL_BOXES; k++)
+	{
+		q = smallBox(k);
+		query[0] = q.x;
+		query[1] = q.y;
+		query[2] = q.x + q.w;
+		query[3] = q.y + q.h;
+
+		for (i = 0; i < SMALL_BOXES; i++)
+		{
+			b = smallBox(i);
+			expected[i] = reference(q.x, q.y, q.w, q.h, b.x, b.y, b.w, b.h);
+		}
+
+		if (!matches(0, SMALL_BOXES, runBatch(0, SMALL_BOXES, query)))
+		{
+			failures++;
+		}
+
+		// A short run at a shifting offset covers every tail length and misaligned loads.
+		from = k % 8;
+		count = k % 19;
+
+		if (!matches(from, count, runBatch(from, count, query)))
+		{
+			failures++;
+		}
+	}
+
+	return failures;
+}
+
+static long checkRandom(void)
+{
+	float query[4];
+	char *scalar;
+	int i, k, n;
+	long failures;
+	const char *kernel;
+
+	for (i = 0; i < RANDOM_BOXES; i++)
+	{
+		batch.minX[i] = randomCoordinate();
+		batch.minY[i] = randomCoordinate();
+		batch.maxX[i] = (rand() % 4 == 0) ? randomCoordinate() : batch.minX[i] + rand() % 64 * 0.25f;
+		batch.maxY[i] = (rand() % 4 == 0) ? randomCoordinate() : batch.minY[i] + rand() % 64 * 0.25f;
+	}
+
+	scalar = malloc(RANDOM_BOXES);
+	if (scalar == NULL)
+	{
+		fprintf(stderr, "out of memory\n");
+		exit(1);
+	}
+
+	kernel = getAabbKernel();
+	failures = 0;
+
+	for (k = 0; k < RANDOM_QUERIES; k++)
+	{
+		query[0] = randomCoordinate();
+		query[1] = randomCoordinate();
+		query[2] = query[0] + rand() % 256 * 0.25f;
+		query[3] = query[1] + rand() % 256 * 0.25f;
+
+		selectAabbKernel("scalar");
+		memset(scalar, 0, RANDOM_BOXES);
+		n = runBatch(0, RANDOM_BOXES, query);
+
+		for (i = 0; i < n; i++)
+		{
+			scalar[hits[i]] = 1;
+		}
+
+		selectAabbKernel(kernel);
+		memcpy(expected, scalar, RANDOM_BOXES);
+
+		if (!matches(0, RANDOM_BOXES, runBatch(0, RANDOM_BOXES, query)))
+		{
+			failures++;
+		}
+	}
+
+	free(scalar);
+
+	return failures;
+}
+
+static int boxesOverlap(const float *a, const float *b)
+{
+	return a[0] < b[2] && b[0] < a[2] && a[1] < b[3] && b[1] < a[3] && a[0] < a[2] && a[1] < a[3] && b[0] < b[2] && b[1] < b[3];
+}
+
+// The first step at which the moving box overlaps must fall in the window sweepAabb() reports,
+// and a window wider than a step must contain one.
+static long checkSweep(void)
+{
+	float box[4], moved[4], target[4], dx, dy, enter, leave, s;
+	long failures;
+	int i, k, first, hit;
+
+	failures = 0;
+
+	for (i = 0; i < SWEEPS; i++)
+	{
+		box[0] = rand() % 200 - 100;
+		box[1] = rand() % 200 - 100;
+		box[2] = box[0] + rand() % 40;
+		box[3] = box[1] + rand() % 40;
+		target[0] = rand() % 200 - 100;
+		target[1] = rand() % 200 - 100;
+		target[2] = target[0] + rand() % 40;
+		target[3] = target[1] + rand() % 40;
+		dx = (rand() % 5 == 0) ? 0 : (rand() % 401 - 200) * 0.25f;
+		dy = (rand() % 5 == 0) ? 0 : (rand() % 401 - 200) * 0.25f;
+
+		hit = sweepAabb(box, dx, dy, target, &enter, &leave);
+		first = -1;
+
+		for (k = 0; k <= SWEEP_STEPS && first < 0; k++)
+		{
+			s = (float)k / SWEEP_STEPS;
+			moved[0] = box[0] + dx * s;
+			moved[1] = box[1] + dy * s;
+			moved[2] = box[2] + dx * s;
+			moved[3] = box[3] + dy * s;
+
+			if (boxesOverlap(moved, target))
+			{
+				first = k;
+			}
+		}
+
+		if (first >= 0 && (!hit || fabsf((float)first / SWEEP_STEPS - enter) > 2.0f / SWEEP_STEPS))
+		{
+			failures++;
+		}
+		else if (first < 0 && hit && leave - enter > 2.0f / SWEEP_STEPS)
+		{
+			failures++;
+		}
+	}
+
+	return failures;
+}
+
+static void benchmark(long pairs)
+{
+	float query[4];
+	Uint64 start, ticks;
+	long done, found;
+	int i, s, size;
+
+	// Play-field boxes the size of fighters, queried with bullet-sized boxes.
+	for (i = 0; i < RANDOM_BOXES; i++)
+	{
+		batch.minX[i] = rand() % HUDSCREEN_WIDTH;
+		batch.minY[i] = rand() % HUDSCREEN_HEIGHT;
+		batch.maxX[i] = batch.minX[i] + 48;
+		batch.maxY[i] = batch.minY[i] + 48;
+	}
+
+	for (s = 0; s < (int)(sizeof(batchSizes) / sizeof(batchSizes[0])); s++)
+	{
+		size = batchSizes[s];
+		done = 0;
+		found = 0;
+		i = 0;
+
+		start = SDL_GetPerformanceCounter();
+
+		while (done < pairs)
+		{
+			query[0] = batch.minX[i] + 16;
+			query[1] = batch.minY[i] + 16;
+			query[2] = query[0] + 16;
+			query[3] = query[1] + 8;
+
+			found += runBatch(i % (RANDOM_BOXES - size + 1), size, query);
+			done += size;
+			i = (i + 1) % RANDOM_BOXES;
+		}
+
+		ticks = SDL_GetPerformanceCounter() - start;
+
+		printf("  %-8s batch %5d: %7.3f ns/pair, %5.2f%% hit\n", getAabbKernel(), size,
+			ticks * 1e9 / SDL_GetPerformanceFrequency() / done, 100.0 * found / done);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	const char *name;
+	long pairs, failures, small, random;
+	int i, ok;
+
+	pairs = (argc > 1) ? atol(argv[1]) : 20000000;
+	if (pairs <= 0)
+	{
+		fprintf(stderr, "usage: %s [pairs]\n", argv[0]);
+		return 2;
+	}
+
+	srand(1);
+	allocBatch(MAX(SMALL_BOXES, RANDOM_BOXES));
+
+	failures = checkSweep();
+	ok = failures == 0;
+
+	printf("sweep: %d random sweeps against stepped overlap tests %s\n", SWEEPS, failures ? "MISMATCH" : "match");
+
+	for (i = 0; (name = aabbKernelName(i)) != NULL; i++)
+	{
+		if (selectAabbKernel(name) == NULL)
+		{
+			printf("%s: not supported on this CPU, skipped\n", name);
+			continue;
+		}
+
+		small = checkSmall();
+		random = checkRandom();
+		failures = small + random;
+
+		printf("%s: %d small boxes against each other %s, %d random queries %s\n", name,
+			SMALL_BOXES, small ? "MISMATCH" : "match", RANDOM_QUERIES, random ? "MISMATCH" : "match");
+
+		if (failures > 0)
+		{
+			ok = 0;
+			continue;
+		}
+
+		benchmark(pairs);
+	}
+
+	return ok ? 0 : 1;
+}
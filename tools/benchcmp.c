@@ -0,0 +1,651 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+// Compares benchmark.json reports written by --benchmark.
+// The first report of each scenario is the baseline; every later report of the same scenario is compared against it.
+// Usage: benchcmp [--alpha A] [--threshold PCT] [--bootstrap N] base.json new.json [...]
+
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_REPORTS 32
+#define NUM_PHASES 3
+
+enum
+{
+	JSON_NULL,
+	JSON_NUMBER,
+	JSON_STRING,
+	JSON_ARRAY,
+	JSON_OBJECT
+};
+
+typedef struct Json Json;
+
+struct Json
+{
+	int type;
+	char *key;
+	char *string;
+	double number;
+	Json *child;
+	Json *next;
+};
+
+typedef struct
+{
+	double *samples;
+	int count;
+} Series;
+
+typedef struct
+{
+	const char *filename;
+	const char *scenario;
+	Series phases[NUM_PHASES];
+	double allocations;
+	int frames;
+	int warmup;
+	Json *root;
+} Report;
+
+static const char *phaseNames[NUM_PHASES] = {"frame", "logic", "draw"};
+
+static double alpha = 0.05;
+static double threshold = 1.0;
+static int bootstrapRounds = 2000;
+static unsigned long long rngState = 0x9e3779b97f4a7c15ULL;
+
+static void skipSpace(const char **p)
+{
+	while (isspace((unsigned char)**p))
+	{
+		(*p)++;
+	}
+}
+
+static char *parseString(const char **p)
+{
+	char *out, *o;
+	const char *s;
+
+	s = *p + 1;
+	out = o = malloc(strlen(s) + 1);
+
+	while (*s && *s != '"')
+	{
+		if (*s == '\\' && s[1])
+		{
+			s++;
+
+			switch (*s)
+			{
+				case 'n': *o++ = '\n'; break;
+				case 't': *o++ = '\t'; break;
+				case 'u': *o++ = '?'; s += (strlen(s) >= 5) ? 4 : 0; break;
+				default: *o++ = *s; break;
+			}
+
+			s++;
+		}
+		else
+		{
+			*o++ = *s++;
+		}
+	}
+
+	*o = '\0';
+	*p = (*s == '"') ? s + 1 : s;
+
+	return out;
+}
+
+static Json *parseValue(const char **p)
+{
+	Json *node, **tail;
+	char *end;
+
+	skipSpace(p);
+
+	node = calloc(1, sizeof(Json));
+
+	if (**p == '{' || **p == '[')
+	{
+		node->type = (**p == '{') ? JSON_OBJECT : JSON_ARRAY;
+		(*p)++;
+		tail = &node->child;
+
+		for (;;)
+		{
+			char *key = NULL;
+
+			skipSpace(p);
+
+			if (**p == '}' || **p == ']')
+			{
+				(*p)++;
+				break;
+			}
+
+			if (node->type == JSON_OBJECT)
+			{
+				if (**p != '"')
+				{
+					return NULL;
+				}
+
+				key = parseString(p);
+				skipSpace(p);
+
+				if (**p != ':')
+				{
+					return NULL;
+				}
+
+				(*p)++;
+			}
+
+			*tail = parseValue(p);
+			if (*tail == NULL)
+			{
+				return NULL;
+			}
+
+			(*tail)->key = key;
+			tail = &(*tail)->next;
+
+			skipSpace(p);
+
+			if (**p == ',')
+			{
+				(*p)++;
+			}
+		}
+	}
+	else if (**p == '"')
+	{
+		node->type = JSON_STRING;
+		node->string = parseString(p);
+	}
+	else if (strncmp(*p, "null", 4) == 0 || strncmp(*p, "true", 4) == 0)
+	{
+		node->type = (**p == 't') ? JSON_NUMBER : JSON_NULL;
+		node->number = 1;
+		*p += 4;
+	}
+	else if (strncmp(*p, "false", 5) == 0)
+	{
+		node->type = JSON_NUMBER;
+		*p += 5;
+	}
+	else
+	{
+		node->type = JSON_NUMBER;
+		node->number = strtod(*p, &end);
+
+		if (end == *p)
+		{
+			return NULL;
+		}
+
+		*p = end;
+	}
+
+	return node;
+}
+
+static Json *jsonGet(Json *object, const char *key)
+{
+	Json *child;
+
+	if (object == NULL || object->type != JSON_OBJECT)
+	{
+		return NULL;
+	}
+
+	for (child = object->child; child != NULL; child = child->next)
+	{
+		if (strcmp(child->key, key) == 0)
+		{
+			return child;
+		}
+	}
+
+	return NULL;
+}
+
+static double jsonNumber(Json *object, const char *key, double fallback)
+{
+	Json *value = jsonGet(object, key);
+
+	return (value != NULL && value->type == JSON_NUMBER) ? value->number : fallback;
+}
+
+static int loadReport(const char *filename, Report *report)
+{
+	Json *samples, *array, *item;
+	const char *cursor;
+	char *text;
+	FILE *file;
+	long size;
+	int i, n;
+
+	file = fopen(filename, "rb");
+	if (file == NULL)
+	{
+		fprintf(stderr, "%s: couldn't open\n", filename);
+		return 0;
+	}
+
+	fseek(file, 0, SEEK_END);
+	size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	text = malloc(size + 1);
+	text[fread(text, 1, size, file)] = '\0';
+	fclose(file);
+
+	cursor = text;
+	memset(report, 0, sizeof(Report));
+	report->filename = filename;
+	report->root = parseValue(&cursor);
+
+	free(text);
+
+	samples = jsonGet(report->root, "samples");
+	if (samples == NULL)
+	{
+		fprintf(stderr, "%s: not a benchmark report with raw samples\n", filename);
+		return 0;
+	}
+
+	report->scenario = (jsonGet(report->root, "scenario") != NULL) ? jsonGet(report->root, "scenario")->string : "?";
+	report->frames = jsonNumber(report->root, "frames", 0);
+	report->warmup = jsonNumber(report->root, "warmup", 0);
+	report->allocations = jsonNumber(report->root, "allocations", -1);
+
+	for (i = 0; i < NUM_PHASES; i++)
+	{
+		array = jsonGet(samples, phaseNames[i]);
+
+		for (n = 0, item = (array != NULL) ? array->child : NULL; item != NULL; item = item->next)
+		{
+			n++;
+		}
+
+		report->phases[i].samples = malloc(sizeof(double) * (n + 1));
+		report->phases[i].count = n;
+
+		for (n = 0, item = (array != NULL) ? array->child : NULL; item != NULL; item = item->next)
+		{
+			report->phases[i].samples[n++] = item->number;
+		}
+	}
+
+	return 1;
+}
+
+static int compareDoubles(const void *a, const void *b)
+{
+	double d1 = *(const double *)a;
+	double d2 = *(const double *)b;
+
+	return (d1 > d2) - (d1 < d2);
+}
+
+// Nearest-rank, the same definition the game uses for its own summary.
+static double percentile(double *sorted, int count, double p)
+{
+	int rank;
+
+	rank = (int)ceil(p / 100.0 * count) - 1;
+	rank = (rank < 0) ? 0 : (rank >= count) ? count - 1 : rank;
+
+	return sorted[rank];
+}
+
+static double sortedPercentile(const double *samples, int count, double p, double *scratch)
+{
+	memcpy(scratch, samples, sizeof(double) * count);
+	qsort(scratch, count, sizeof(double), compareDoubles);
+
+	return percentile(scratch, count, p);
+}
+
+static unsigned nextRandom(void)
+{
+	rngState ^= rngState << 13;
+	rngState ^= rngState >> 7;
+	rngState ^= rngState << 17;
+
+	return (unsigned)(rngState >> 32);
+}
+
+// Value of the k-th smallest sample (0-based), partially reordering the array: O(n) where a sort would be O(n log n).
+static double selectKth(double *values, int count, int k)
+{
+	double pivot, t;
+	int left, right, i, j;
+
+	left = 0;
+	right = count - 1;
+
+	while (left < right)
+	{
+		pivot = values[(left + right) / 2];
+		i = left;
+		j = right;
+
+		while (i <= j)
+		{
+			while (values[i] < pivot)
+			{
+				i++;
+			}
+
+			while (values[j] > pivot)
+			{
+				j--;
+			}
+
+			if (i <= j)
+			{
+				t = values[i];
+				values[i] = values[j];
+				values[j] = t;
+				i++;
+				j--;
+			}
+		}
+
+		if (k <= j)
+		{
+			right = j;
+		}
+		else if (k >= i)
+		{
+			left = i;
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	return values[k];
+}
+
+static double resampledPercentile(double *values, int count, double p)
+{
+	int rank;
+
+	rank = (int)ceil(p / 100.0 * count) - 1;
+	rank = (rank < 0) ? 0 : (rank >= count) ? count - 1 : rank;
+
+	return selectKth(values, count, rank);
+}
+
+// Percentile-bootstrap confidence intervals of the relative change in each percentile, in percent.
+static void bootstrapDeltas(Series *a, Series *b, const int *stats, int numStats, double *low, double *high)
+{
+	double *ra, *rb, *deltas, pa, pb;
+	int i, j, s;
+
+	ra = malloc(sizeof(double) * a->count);
+	rb = malloc(sizeof(double) * b->count);
+	deltas = malloc(sizeof(double) * bootstrapRounds * numStats);
+
+	for (i = 0; i < bootstrapRounds; i++)
+	{
+		for (j = 0; j < a->count; j++)
+		{
+			ra[j] = a->samples[nextRandom() % a->count];
+		}
+
+		for (j = 0; j < b->count; j++)
+		{
+			rb[j] = b->samples[nextRandom() % b->count];
+		}
+
+		for (s = 0; s < numStats; s++)
+		{
+			pa = resampledPercentile(ra, a->count, stats[s]);
+			pb = resampledPercentile(rb, b->count, stats[s]);
+
+			deltas[s * bootstrapRounds + i] = (pa > 0) ? (pb - pa) / pa * 100.0 : 0;
+		}
+	}
+
+	for (s = 0; s < numStats; s++)
+	{
+		qsort(&deltas[s * bootstrapRounds], bootstrapRounds, sizeof(double), compareDoubles);
+
+		low[s] = percentile(&deltas[s * bootstrapRounds], bootstrapRounds, alpha / 2 * 100);
+		high[s] = percentile(&deltas[s * bootstrapRounds], bootstrapRounds, (1 - alpha / 2) * 100);
+	}
+
+	free(ra);
+	free(rb);
+	free(deltas);
+}
+
+typedef struct
+{
+	double value;
+	int group;
+} Ranked;
+
+static int compareRanked(const void *a, const void *b)
+{
+	return compareDoubles(&((const Ranked *)a)->value, &((const Ranked *)b)->value);
+}
+
+// Two-sided Mann-Whitney U test, normal approximation with tie correction.
+static double mannWhitney(Series *a, Series *b)
+{
+	Ranked *all;
+	double rankSum, ties, n1, n2, n, u, mean, variance, z, rank;
+	int i, j, k, total;
+
+	total = a->count + b->count;
+	all = malloc(sizeof(Ranked) * total);
+
+	for (i = 0; i < a->count; i++)
+	{
+		all[i].value = a->samples[i];
+		all[i].group = 0;
+	}
+
+	for (i = 0; i < b->count; i++)
+	{
+		all[a->count + i].value = b->samples[i];
+		all[a->count + i].group = 1;
+	}
+
+	qsort(all, total, sizeof(Ranked), compareRanked);
+
+	rankSum = 0;
+	ties = 0;
+
+	for (i = 0; i < total; i = j)
+	{
+		for (j = i + 1; j < total && all[j].value == all[i].value; j++)
+		{
+		}
+
+		rank = (i + 1 + j) / 2.0;
+
+		for (k = i; k < j; k++)
+		{
+			if (all[k].group == 0)
+			{
+				rankSum += rank;
+			}
+		}
+
+		ties += pow(j - i, 3) - (j - i);
+	}
+
+	free(all);
+
+	n1 = a->count;
+	n2 = b->count;
+	n = n1 + n2;
+
+	u = rankSum - n1 * (n1 + 1) / 2;
+	mean = n1 * n2 / 2;
+	variance = n1 * n2 / 12 * ((n + 1) - ties / (n * (n - 1)));
+
+	if (variance <= 0)
+	{
+		return 1;
+	}
+
+	z = (fabs(u - mean) - 0.5) / sqrt(variance);
+
+	return erfc(fmax(z, 0) / sqrt(2));
+}
+
+static int compareReports(Report *base, Report *next)
+{
+	double *scratch, pb, pn, low[2], high[2], p, delta;
+	const char *verdict;
+	int i, s, regressions;
+	static const int stats[2] = {50, 99};
+	double allocBase, allocNext;
+
+	regressions = 0;
+
+	printf("\n%s: %s -> %s\n\n", base->scenario, base->filename, next->filename);
+	printf("| phase | stat |     base |      new |   delta |       %2.0f%% CI       | p (MWU) |            |\n", (1 - alpha) * 100);
+	printf("|-------|------|---------:|---------:|--------:|:------------------:|--------:|------------|\n");
+
+	for (i = 0; i < NUM_PHASES; i++)
+	{
+		Series *a = &base->phases[i];
+		Series *b = &next->phases[i];
+
+		if (a->count == 0 || b->count == 0)
+		{
+			continue;
+		}
+
+		scratch = malloc(sizeof(double) * ((a->count > b->count) ? a->count : b->count));
+		p = mannWhitney(a, b);
+		bootstrapDeltas(a, b, stats, 2, low, high);
+
+		for (s = 0; s < 2; s++)
+		{
+			pb = sortedPercentile(a->samples, a->count, stats[s], scratch);
+			pn = sortedPercentile(b->samples, b->count, stats[s], scratch);
+			delta = (pb > 0) ? (pn - pb) / pb * 100.0 : 0;
+
+			// Significant only if the interval excludes zero, the distributions differ, and the change is big enough to care.
+			verdict = "";
+			if (p < alpha && low[s] > 0 && delta >= threshold)
+			{
+				verdict = "REGRESSION";
+				regressions++;
+			}
+			else if (p < alpha && high[s] < 0 && -delta >= threshold)
+			{
+				verdict = "improved";
+			}
+
+			printf("| %-5s | p%-3d | %8.3f | %8.3f | %+6.1f%% | [%+6.1f%%, %+6.1f%%] | %7.4f | %-10s |\n",
+				phaseNames[i], stats[s], pb, pn, delta, low[s], high[s], p, verdict);
+		}
+
+		free(scratch);
+	}
+
+	// The runs are seeded and scripted, so allocation counts are deterministic: any growth is real.
+	if (base->allocations >= 0 && next->allocations >= 0)
+	{
+		allocBase = base->allocations / (base->frames + base->warmup);
+		allocNext = next->allocations / (next->frames + next->warmup);
+		delta = (allocBase > 0) ? (allocNext - allocBase) / allocBase * 100.0 : 0;
+		verdict = "";
+
+		if (allocNext > allocBase && delta >= threshold)
+		{
+			verdict = "REGRESSION";
+			regressions++;
+		}
+		else if (allocNext < allocBase && -delta >= threshold)
+		{
+			verdict = "improved";
+		}
+
+		printf("| alloc | /frm | %8.2f | %8.2f | %+6.1f%% |                    |         | %-10s |\n", allocBase, allocNext, delta, verdict);
+	}
+
+	return regressions;
+}
+
+int main(int argc, char *argv[])
+{
+	Report reports[MAX_REPORTS];
+	int i, j, count, regressions;
+
+	count = 0;
+
+	for (i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--alpha") == 0 && i + 1 < argc)
+		{
+			alpha = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc)
+		{
+			threshold = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--bootstrap") == 0 && i + 1 < argc)
+		{
+			bootstrapRounds = atoi(argv[++i]);
+			bootstrapRounds = (bootstrapRounds < 100) ? 100 : bootstrapRounds;
+		}
+		else if (count < MAX_REPORTS)
+		{
+			if (!loadReport(argv[i], &reports[count]))
+			{
+				return 2;
+			}
+
+			count++;
+		}
+	}
+
+	if (count < 2)
+	{
+		fprintf(stderr, "usage: %s [--alpha A] [--threshold PCT] [--bootstrap N] base.json new.json [...]\n", argv[0]);
+		return 2;
+	}
+
+	regressions = 0;
+
+	for (i = 1; i < count; i++)
+	{
+		// Baseline is the first report with the same scenario.
+		for (j = 0; j < i && strcmp(reports[j].scenario, reports[i].scenario) != 0; j++)
+		{
+		}
+
+		if (j == i)
+		{
+			printf("\n%s: %s is the baseline for this scenario\n", reports[i].scenario, reports[i].filename);
+			continue;
+		}
+
+		regressions += compareReports(&reports[j], &reports[i]);
+	}
+
+	printf("\n%d significant regression%s (alpha %.2f, threshold %.1f%%, %d bootstrap rounds)\n",
+		regressions, (regressions == 1) ? "" : "s", alpha, threshold, bootstrapRounds);
+
+	return (regressions > 0) ? 1 : 0;
+}
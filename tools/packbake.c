@@ -0,0 +1,306 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+// Bakes PNGs and sound effects into one asset pack the game maps at startup.
+// Images are stored in the renderer's preferred pixel format and sounds already converted
+// to the mixer's device format, so the game creates textures and chunks without decoding.
+// Usage: packbake voidfighter.pak gfx/player.png "sound/voidfighter - Track 02 (PlayerFire).ogg" [...]
+// Names are stored exactly as given, so run it from the directory the game runs in.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <SDL2/SDL_mixer.h>
+
+#include "../src/defs.h"
+#include "../src/packformat.h"
+
+static Uint32 pixelFormat;
+static int frequency;
+static Uint16 audioFormat;
+static int channels;
+
+static int compareNames(const void *a, const void *b)
+{
+	return strcmp(*(const char **)a, *(const char **)b);
+}
+
+static int hasSuffix(const char *name, const char *suffix)
+{
+	size_t n, m;
+
+	n = strlen(name);
+	m = strlen(suffix);
+
+	return n >= m && strcmp(name + n - m, suffix) == 0;
+}
+
+static Uint32 preferredPixelFormat(void)
+{
+	SDL_Window *window;
+	SDL_Renderer *renderer;
+	SDL_RendererInfo info;
+	Uint32 format;
+	unsigned i;
+
+	format = SDL_PIXELFORMAT_ARGB8888;
+
+	// Ask a hidden renderer what it takes natively; a headless build machine gets the common default.
+	window = SDL_CreateWindow("packbake", 0, 0, 1, 1, SDL_WINDOW_HIDDEN);
+	renderer = (window != NULL) ? SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED) : NULL;
+
+	if (renderer != NULL && SDL_GetRendererInfo(renderer, &info) == 0)
+	{
+		for (i = 0; i < info.num_texture_formats; i++)
+		{
+			if (!SDL_ISPIXELFORMAT_FOURCC(info.texture_formats[i]) && SDL_BYTESPERPIXEL(info.texture_formats[i]) == 4)
+			{
+				format = info.texture_formats[i];
+				break;
+			}
+		}
+	}
+
+	if (renderer != NULL)
+	{
+		SDL_DestroyRenderer(renderer);
+	}
+
+	if (window != NULL)
+	{
+		SDL_DestroyWindow(window);
+	}
+
+	return format;
+}
+
+static int pad(FILE *file)
+{
+	long position;
+
+	position = ftell(file);
+
+	while (position % PACK_ALIGN != 0)
+	{
+		fputc(0, file);
+		position++;
+	}
+
+	return ferror(file) == 0;
+}
+
+static int bakeImage(FILE *file, PackEntry *entry)
+{
+	SDL_Surface *surface, *converted;
+	int y, pitch;
+
+	surface = IMG_Load(entry->name);
+	if (surface == NULL)
+	{
+		fprintf(stderr, "%s: %s\n", entry->name, IMG_GetError());
+		return 0;
+	}
+
+	converted = SDL_ConvertSurfaceFormat(surface, pixelFormat, 0);
+	SDL_FreeSurface(surface);
+	if (converted == NULL)
+	{
+		fprintf(stderr, "%s: %s\n", entry->name, SDL_GetError());
+		return 0;
+	}
+
+	// Rows are written tightly packed; SDL_UpdateTexture takes any pitch.
+	pitch = converted->w * SDL_BYTESPERPIXEL(pixelFormat);
+
+	entry->type = PACK_IMAGE;
+	entry->format = pixelFormat;
+	entry->w = converted->w;
+	entry->h = converted->h;
+	entry->pitch = pitch;
+	entry->size = (uint64_t)pitch * converted->h;
+
+	SDL_LockSurface(converted);
+
+	for (y = 0; y < converted->h; y++)
+	{
+		fwrite((Uint8 *)converted->pixels + y * converted->pitch, pitch, 1, file);
+	}
+
+	SDL_UnlockSurface(converted);
+	SDL_FreeSurface(converted);
+
+	return 1;
+}
+
+static int bakeSound(FILE *file, PackEntry *entry)
+{
+	Mix_Chunk *chunk;
+
+	// Mix_LoadWAV decodes and resamples to the open device's format; the pack keeps the result.
+	chunk = Mix_LoadWAV(entry->name);
+	if (chunk == NULL)
+	{
+		fprintf(stderr, "%s: %s\n", entry->name, Mix_GetError());
+		return 0;
+	}
+
+	entry->type = PACK_SOUND;
+	entry->format = audioFormat;
+	entry->frequency = frequency;
+	entry->channels = channels;
+	entry->size = chunk->alen;
+
+	fwrite(chunk->abuf, chunk->alen, 1, file);
+
+	Mix_FreeChunk(chunk);
+
+	return 1;
+}
+
+static int bake(const char *filename, char **names, int count)
+{
+	PackHeader header;
+	PackEntry *entries;
+	FILE *file;
+	long imageBytes, soundBytes;
+	int i, ok;
+
+	entries = calloc(count, sizeof(PackEntry));
+	if (entries == NULL)
+	{
+		fprintf(stderr, "out of memory\n");
+		return 0;
+	}
+
+	file = fopen(filename, "wb");
+	if (file == NULL)
+	{
+		fprintf(stderr, "%s: couldn't create\n", filename);
+		free(entries);
+		return 0;
+	}
+
+	// The game binary-searches the index, so it is written sorted by name.
+	qsort(names, count, sizeof(char *), compareNames);
+
+	memset(&header, 0, sizeof(header));
+	fwrite(&header, sizeof(header), 1, file);
+	fwrite(entries, sizeof(PackEntry), count, file);
+
+	imageBytes = 0;
+	soundBytes = 0;
+	ok = pad(file);
+
+	for (i = 0; i < count && ok; i++)
+	{
+		if (strlen(names[i]) >= PACK_NAME_LENGTH)
+		{
+			fprintf(stderr, "%s: name longer than %d characters\n", names[i], PACK_NAME_LENGTH - 1);
+			ok = 0;
+			break;
+		}
+
+		strcpy(entries[i].name, names[i]);
+		entries[i].offset = ftell(file);
+
+		if (hasSuffix(names[i], ".png"))
+		{
+			ok = bakeImage(file, &entries[i]);
+			imageBytes += (long)entries[i].size;
+		}
+		else if (hasSuffix(names[i], ".ogg") || hasSuffix(names[i], ".wav"))
+		{
+			ok = bakeSound(file, &entries[i]);
+			soundBytes += (long)entries[i].size;
+		}
+		else
+		{
+			fprintf(stderr, "%s: not a .png, .ogg or .wav\n", names[i]);
+			ok = 0;
+		}
+
+		ok = ok && pad(file);
+	}
+
+	if (ok)
+	{
+		memcpy(header.magic, PACK_MAGIC, 4);
+		header.version = PACK_VERSION;
+		header.entrySize = sizeof(PackEntry);
+		header.count = count;
+		header.size = ftell(file);
+
+		fseek(file, 0, SEEK_SET);
+		fwrite(&header, sizeof(header), 1, file);
+		fwrite(entries, sizeof(PackEntry), count, file);
+
+		ok = ferror(file) == 0;
+	}
+
+	ok = (fclose(file) == 0) && ok;
+
+	if (!ok)
+	{
+		remove(filename);
+	}
+	else
+	{
+		printf("%s: %d assets, %ld KB of pixels as %s, %ld KB of audio at %d Hz, %d channels, format 0x%x\n",
+			filename, count, imageBytes / 1024, SDL_GetPixelFormatName(pixelFormat), soundBytes / 1024, frequency, channels, audioFormat);
+	}
+
+	free(entries);
+
+	return ok;
+}
+
+int main(int argc, char *argv[])
+{
+	int ok;
+
+	if (argc < 3)
+	{
+		fprintf(stderr, "usage: %s out.pak asset [...]\n", argv[0]);
+		return 2;
+	}
+
+	// Nothing is shown or played; the dummy audio driver opens exactly the format requested.
+	SDL_SetHint(SDL_HINT_AUDIODRIVER, "dummy");
+
+	if (SDL_Init(SDL_INIT_AUDIO) < 0)
+	{
+		fprintf(stderr, "SDL_Init: %s\n", SDL_GetError());
+		return 1;
+	}
+
+	if (SDL_InitSubSystem(SDL_INIT_VIDEO) < 0)
+	{
+		fprintf(stderr, "no video (%s), baking pixels as ARGB8888\n", SDL_GetError());
+		pixelFormat = SDL_PIXELFORMAT_ARGB8888;
+	}
+	else
+	{
+		pixelFormat = preferredPixelFormat();
+	}
+
+	IMG_Init(IMG_INIT_PNG);
+
+	if (Mix_OpenAudio(AUDIO_FREQUENCY, MIX_DEFAULT_FORMAT, AUDIO_CHANNELS, AUDIO_CHUNK_SIZE) == -1 || !Mix_QuerySpec(&frequency, &audioFormat, &channels))
+	{
+		fprintf(stderr, "Mix_OpenAudio: %s\n", Mix_GetError());
+		SDL_Quit();
+		return 1;
+	}
+
+	ok = bake(argv[1], argv + 2, argc - 2);
+
+	Mix_CloseAudio();
+	IMG_Quit();
+	SDL_Quit();
+
+	return ok ? 0 : 1;
+}
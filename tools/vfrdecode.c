@@ -0,0 +1,92 @@
+/*
+Copyright (C) 2023-2025 Asephri.net. All rights reserved.
+*/
+
+// Decodes hitch_*.vfr flight recordings written by the game into a readable table.
+// Usage: vfrdecode hitch_001234.vfr [...]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/recordformat.h"
+
+static const char *sceneNames[] = {"title", "stage", "scores"};
+
+static int decode(const char *filename)
+{
+	FlightHeader header;
+	FlightRecord record;
+	FILE *file;
+	const char *scene;
+	unsigned i;
+	char mark;
+
+	file = fopen(filename, "rb");
+	if (file == NULL)
+	{
+		fprintf(stderr, "%s: couldn't open\n", filename);
+		return 1;
+	}
+
+	if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, RECORD_MAGIC, 4) != 0)
+	{
+		fprintf(stderr, "%s: not a flight recording\n", filename);
+		fclose(file);
+		return 1;
+	}
+
+	if (header.version != RECORD_VERSION || header.recordSize != sizeof(FlightRecord))
+	{
+		fprintf(stderr, "%s: unsupported version %u (record size %u)\n", filename, header.version, header.recordSize);
+		fclose(file);
+		return 1;
+	}
+
+	printf("%s: %u frames, triggered at frame %u, budget %.1f ms at %u FPS\n",
+		filename, header.count, header.triggerFrame, header.budgetMs, header.fps);
+	printf("  ! = over budget, * = trigger frame\n\n");
+	printf("   frame scene    frame  logic   draw  intvl   ftr   blt    exp   deb   trl   fire  pts  spawn  free snd  coll  tex\n");
+
+	for (i = 0; i < header.count; i++)
+	{
+		if (fread(&record, sizeof(record), 1, file) != 1)
+		{
+			fprintf(stderr, "%s: truncated after %u records\n", filename, i);
+			break;
+		}
+
+		mark = (record.frame == header.triggerFrame) ? '*' : (record.frameMs > header.budgetMs) ? '!' : ' ';
+		scene = (record.scene < sizeof(sceneNames) / sizeof(sceneNames[0])) ? sceneNames[record.scene] : "?";
+
+		printf("%c%7u %-6s %6.2f %6.2f %6.2f %6.2f %5u %5u %6u %5u %5u %6u %4u %6u %5u %3u %5u %4u\n",
+			mark, record.frame, scene, record.frameMs, record.logicMs, record.drawMs, record.intervalMs,
+			record.entities[0], record.entities[1], record.entities[2], record.entities[3],
+			record.entities[4], record.entities[5], record.entities[6],
+			record.spawns, record.frees, record.sounds, record.collisionTests, record.textureMisses);
+	}
+
+	fclose(file);
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int i, result;
+
+	if (argc < 2)
+	{
+		fprintf(stderr, "usage: %s hitch_NNNNNN.vfr [...]\n", argv[0]);
+		return 2;
+	}
+
+	result = 0;
+
+	for (i = 1; i < argc; i++)
+	{
+		result |= decode(argv[i]);
+	}
+
+	return result;
+}